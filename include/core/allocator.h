@@ -20,6 +20,10 @@ namespace infini {
 
     size_t peak; // 历史最高内存使用量（用来分析内存峰值）
 
+    // peak 在 free() 回收尾部空闲块时会变小，但之前分配出去的 offset 仍然可能
+    // 落在那段区域里，所以 getPtr() 必须按曾经达到过的最大 peak 申请内存
+    size_t highWater;
+
     size_t alignment; // 内存对齐要求（比如为了性能，地址必须是 256 字节的倍数）
 
     // pointer to the memory actually allocated
@@ -72,6 +76,9 @@ namespace infini {
 
     void info();
 
+    // 峰值内存（字节），即 getPtr() 真正申请的大小
+    size_t getPeak() const { return highWater; }
+
   private:
     // function: memory alignment, rouned up
     // return: size of the aligned memory block
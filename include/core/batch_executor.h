@@ -0,0 +1,77 @@
+#pragma once
+#include "core/graph.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace infini {
+
+/**
+ * @brief Coalesces single-sample requests into batched runs of one graph.
+ *
+ * The graph is built and dataMalloc()'d with the leading dimension of every
+ * batched input equal to `maxBatch`. For a batch of n requests the executor
+ * sets that dimension to n, re-runs GraphObj::shape_infer(), copies the samples
+ * into the input buffers, runs the graph once and splits every graph output
+ * along its leading dimension. Tensors are contiguous and only ever shrink, so
+ * the buffers planned for `maxBatch` stay valid for every smaller batch.
+ */
+class BatchExecutor {
+  public:
+    // One byte buffer per batched input (for requests) or per graph output
+    // (for results), in the order of `batchInputs` / GraphObj::getOutputs().
+    using Sample = vector<vector<uint8_t>>;
+
+  private:
+    struct Request {
+        Sample inputs;
+        std::promise<Sample> result;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    Graph graph;
+    TensorVec batchInputs;
+    vector<size_t> sampleBytes; // Bytes of one sample of each batched input
+    int maxBatch;
+    std::chrono::microseconds timeout;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<Request> queue;
+    bool stopping = false;
+    size_t nBatches = 0;
+    std::thread worker;
+
+  public:
+    /**
+     * @param graph A topo-sortable graph whose data has been allocated.
+     * @param batchInputs Graph inputs that carry the batch dimension. Other
+     * inputs (e.g. weights) are shared by all samples.
+     * @param maxBatch Leading dimension of `batchInputs` at dataMalloc() time.
+     * @param timeout How long the oldest queued request may wait for the batch
+     * to fill up.
+     */
+    BatchExecutor(Graph graph, TensorVec batchInputs, int maxBatch,
+                  std::chrono::microseconds timeout);
+    BatchExecutor(const BatchExecutor &) = delete;
+    BatchExecutor &operator=(const BatchExecutor &) = delete;
+    ~BatchExecutor();
+
+    /**
+     * @brief Enqueues one sample. The future holds the sample's slice of every
+     * graph output, or the exception thrown while running its batch.
+     */
+    std::future<Sample> submit(Sample inputs);
+
+    // Number of graph runs issued so far.
+    size_t numBatches();
+
+  private:
+    void loop();
+    void runBatch(vector<Request> &batch);
+};
+
+} // namespace infini
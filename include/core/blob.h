@@ -1,6 +1,7 @@
 #pragma once
 #include "core/common.h"
 #include "core/ref.h"
+#include <memory>
 
 namespace infini {
 
@@ -11,9 +12,14 @@ class BlobObj
 {
   Runtime runtime;
   void *ptr;
+  // Keeps the memory behind `ptr` alive when the blob points into memory the
+  // runtime did not allocate, e.g. a shared-memory mapping
+  std::shared_ptr<const void> owner;
 
 public:
-  BlobObj(Runtime runtime, void *ptr) : runtime(runtime), ptr(ptr) {}
+  BlobObj(Runtime runtime, void *ptr,
+          std::shared_ptr<const void> owner = nullptr)
+      : runtime(runtime), ptr(ptr), owner(std::move(owner)) {}
   BlobObj(BlobObj &other) = delete;
   BlobObj &operator=(BlobObj const &) = delete;
   ~BlobObj() {};
@@ -0,0 +1,90 @@
+#pragma once
+#include "core/common.h"
+
+namespace infini {
+
+/**
+ * @brief Instruction set levels the CPU kernels are compiled for. Levels are
+ * ordered, so a host supporting a level supports all lower ones.
+ */
+enum class CpuIsa {
+    Scalar = 0, // baseline x86-64 (SSE2) or non-x86 targets
+    SSE4 = 1,   // SSE4.1 + SSE4.2
+    AVX2 = 2,   // AVX2 + FMA
+    AVX512 = 3, // AVX-512 F/BW/DQ/VL
+};
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool sse42 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512dq = false;
+    bool avx512vl = false;
+    bool avx512vnni = false;
+    bool avxvnni = false;
+};
+
+// Features reported by CPUID and enabled by the OS (XCR0), detected once.
+const CpuFeatures &getCpuFeatures();
+
+/**
+ * @brief The best ISA level of this host, detected once at startup. The
+ * INFINI_CPU_ISA environment variable (scalar/sse4/avx2/avx512) can lower it,
+ * e.g. to reproduce the behavior of older hosts.
+ */
+CpuIsa detectCpuIsa();
+
+const char *isaToString(CpuIsa isa);
+optional<CpuIsa> isaFromString(const string &name);
+
+/**
+ * @brief Restricts the calling thread to the given logical CPUs. Throws if
+ * a CPU is not available to this process. A no-op on non-Linux hosts.
+ */
+void pinCurrentThread(const vector<int> &cpus);
+
+// Logical CPUs this process may run on, in ascending order, read on the
+// first call.
+const vector<int> &getAvailableCpus();
+
+/**
+ * @brief The CPUs a runtime runs its threads on and how it shares them with
+ * other runtimes of the process.
+ */
+struct CpuPartition {
+    enum class Policy {
+        // No other runtime may use these CPUs. One thread per CPU, each
+        // pinned to its own CPU.
+        Exclusive,
+        // Other shared runtimes may overlap. One thread per CPU, or
+        // `maxThreads` threads, each pinned to the whole set and balanced by
+        // the OS scheduler.
+        Shared,
+    };
+    vector<int> cpus;
+    Policy policy = Policy::Shared;
+    int maxThreads = 0; // Shared only, 0 means one thread per CPU
+    // Whether the CPUs count as used while a runtime holds the partition.
+    // Only all() leaves them unclaimed, so exclusive partitions can still be
+    // carved out next to the default runtime.
+    bool claimed = true;
+
+    // The CPUs must be distinct
+    static CpuPartition exclusive(vector<int> cpus);
+    static CpuPartition shared(vector<int> cpus, int maxThreads = 0);
+    // Shared use of every CPU available to the process, yielding to
+    // exclusive partitions
+    static CpuPartition all();
+
+    int getNumThreads() const;
+    // CPUs the i-th thread is pinned to, the calling thread being thread 0
+    vector<int> getThreadCpus(int i) const;
+    string toString() const;
+};
+
+} // namespace infini
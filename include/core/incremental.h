@@ -0,0 +1,46 @@
+#pragma once
+#include "core/graph.h"
+#include "core/plan.h"
+
+namespace infini {
+
+/**
+ * @brief Re-runs a graph executing only the operators whose inputs changed
+ * since their previous run.
+ *
+ * Every tensor carries a version that setData() and setDataBlob() bump;
+ * code writing an input through getRawDataPtr() calls bumpVersion() itself.
+ * A step runs when the version of one of its inputs or outputs differs from
+ * the one it recorded last time, and its outputs get a new version when it
+ * does, so a change propagates exactly to the operators depending on it.
+ * The other steps keep their previous outputs: for a fixed prefix and a
+ * varying suffix only the suffix is computed again.
+ *
+ * Skipped outputs must survive between runs, so every tensor needs a buffer
+ * of its own. GraphObj::dataMalloc() gives that; memory plans that let
+ * tensors share a buffer are rejected.
+ */
+class IncrementalExecutor {
+    Graph graph;
+    Plan plan;
+    // Per step, the versions of its inputs then outputs when it last ran;
+    // empty before the first run
+    vector<vector<uint64_t>> seen;
+    size_t executed = 0;
+
+  public:
+    explicit IncrementalExecutor(Graph graph);
+
+    // Returns the number of steps executed
+    size_t run();
+    // Makes the next run() execute every step
+    void invalidate();
+
+    size_t getExecutedSteps() const { return executed; }
+    const Plan &getPlan() const { return plan; }
+
+  private:
+    vector<uint64_t> versions(const Operator &op) const;
+};
+
+} // namespace infini
@@ -4,6 +4,8 @@
 #include "core/tensor.h"
 #include "utils/operator_utils.h"
 #include <functional>
+#include <iterator>
+#include <mutex>
 
 namespace infini
 {
@@ -23,6 +25,17 @@ namespace infini
                              const RuntimeObj *context) const = 0;
     };
 
+    /**
+     * @brief Owns every kernel and maps (device, op type, data type) to its
+     * candidates.
+     *
+     * Registration happens from static initializers through getInstance()
+     * and keeps the candidates in a map. Lookups go through sealed(), whose
+     * first call builds a dense table from it, indexed by device,
+     * OpType::underlying() and DataType::getIndex(): each lookup is one
+     * bounds check and one load, no tree walk, no lock, no throw. Once
+     * sealed, no more kernels can be registered.
+     */
     class KernelRegistry
     {
     public:
@@ -30,38 +43,104 @@ namespace infini
             tuple<Kernel *const, const string, const int>; // Kernel, name, ID
 
     private:
-        std::map<KernelAttrs, KernelRecord> kernels;
+        static constexpr size_t NumDTypes = std::size(DataType::names);
+
+        // Several candidates may be registered for one key. The first one is
+        // the default; the others are picked by KernelTuner on real shapes.
+        std::map<KernelAttrs, vector<KernelRecord>> kernels;
         int nKernels = 0;
+        // table[(device * numOpTypes + opType) * NumDTypes + dtype] points
+        // into `kernels`, whose nodes never move
+        vector<const vector<KernelRecord> *> table;
+        size_t numDevices = 0, numOpTypes = 0;
+        std::once_flag tableBuilt;
+        bool isSealed = false;
+
+        void buildTable()
+        {
+            for (auto &[key, records] : kernels)
+            {
+                numDevices = std::max(numDevices,
+                                      (size_t)std::get<0>(key) + 1);
+                numOpTypes = std::max(numOpTypes, (size_t)std::get<1>(key) + 1);
+            }
+            table.assign(numDevices * numOpTypes * NumDTypes, nullptr);
+            for (auto &[key, records] : kernels)
+                table[((size_t)std::get<0>(key) * numOpTypes +
+                       std::get<1>(key)) *
+                          NumDTypes +
+                      std::get<2>(key).getIndex()] = &records;
+            isSealed = true;
+        }
 
     public:
         ~KernelRegistry()
         {
-            for (auto &[k, v] : kernels)
-                delete std::get<0>(v);
+            for (auto &[k, records] : kernels)
+                for (auto &v : records)
+                    delete std::get<0>(v);
         }
         static KernelRegistry &getInstance()
         {
             static KernelRegistry instance;
             return instance;
         }
+        // The registry for lookups, called once static initialization has
+        // registered every kernel
+        static const KernelRegistry &sealed()
+        {
+            auto &instance = getInstance();
+            std::call_once(instance.tableBuilt,
+                           [&instance] { instance.buildTable(); });
+            return instance;
+        }
         bool registerKernel(const KernelAttrs &key, Kernel *kernel, string name)
         {
-            IT_ASSERT(kernels.find(key) == kernels.end(),
-                      "Kernel already registered");
-            kernels.emplace(key, KernelRecord{kernel, name, ++nKernels});
+            IT_ASSERT(!isSealed, "Kernel " + name +
+                                     " registered after the first lookup");
+            auto &records = kernels[key];
+            for (auto &v : records)
+                IT_ASSERT(std::get<1>(v) != name,
+                          "Kernel " + name + " already registered");
+            records.emplace_back(kernel, name, ++nKernels);
             return true;
         }
+        /**
+         * @brief Candidates for a key, default first, or nullptr if there are
+         * none. Only meaningful on sealed().
+         */
+        const vector<KernelRecord> *findKernels(Device device,
+                                                OpType::underlying_t opType,
+                                                DataType dtype) const noexcept
+        {
+            size_t d = (size_t)device, dt = dtype.getIndex();
+            if (d >= numDevices || opType >= numOpTypes || dt >= NumDTypes)
+                return nullptr;
+            return table[(d * numOpTypes + opType) * NumDTypes + dt];
+        }
+        Kernel *findKernel(Device device, OpType::underlying_t opType,
+                           DataType dtype) const noexcept
+        {
+            auto records = findKernels(device, opType, dtype);
+            return records ? std::get<0>(records->front()) : nullptr;
+        }
         Kernel *getKernel(const KernelAttrs &kernelAttrs) const
         {
-            auto it = kernels.find(kernelAttrs);
-            IT_ASSERT(it != kernels.end(), "Kernel not found for key {" +
-                                               get_kernel_attrs_str(kernelAttrs) +
-                                               "}");
-            return std::get<0>(it->second);
+            return std::get<0>(getKernelItem(kernelAttrs));
         }
         const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs) const
         {
-            return kernels.at(kernelAttrs);
+            return getKernels(kernelAttrs).front();
+        }
+        const vector<KernelRecord> &
+        getKernels(const KernelAttrs &kernelAttrs) const
+        {
+            auto records = std::apply(
+                [this](auto... key) { return findKernels(key...); },
+                kernelAttrs);
+            IT_ASSERT(records, "Kernel not found for key {" +
+                                   get_kernel_attrs_str(kernelAttrs) + "}");
+            return *records;
         }
     };
 
@@ -72,16 +151,45 @@ namespace infini
                              const RuntimeObj *context) const = 0;
     };
 
+    /**
+     * @brief Registers one instantiation of the kernel template `K` per data
+     * type index in `N` (see DT<N>), each under its own KernelAttrs key.
+     */
+    template <template <typename> class K, int... N>
+    bool registerTypedKernels(Device device, OpType::underlying_t opType,
+                              const string &name)
+    {
+        auto &registry = KernelRegistry::getInstance();
+        return (registry.registerKernel(
+                    KernelAttrs{device, opType, DataType(N)},
+                    new K<typename DT<N>::t>(), name) &&
+                ...);
+    }
+
 } // namespace infini
 
-#define _REGISTER_KERNEL_1(device, opType, kernel, name, cnt)                 \
+#define _REGISTER_KERNEL_1(device, opType, dataType, kernel, name, cnt)       \
+    namespace infini                                                          \
+    {                                                                         \
+        static const bool _CAT(_register_kernel_, cnt) =                      \
+            KernelRegistry::getInstance().registerKernel(                     \
+                KernelAttrs{device, opType, dataType}, new kernel(), name);   \
+    }
+
+// Registers a kernel class for a single data type, e.g. a hand-specialized
+// int8 path next to a generic template.
+#define REGISTER_KERNEL(device, opType, dataType, kernel, name) \
+    _REGISTER_KERNEL_1(device, opType, dataType, kernel, name, __COUNTER__)
+
+#define _REGISTER_KERNEL_TYPED_1(device, opType, kernel, name, cnt, ...)      \
     namespace infini                                                          \
     {                                                                         \
         static const bool _CAT(_register_kernel_, cnt) =                      \
-            KernelRegistry::getInstance().registerKernel(KernelAttrs{device,  \
-                                                                     opType}, \
-                                                         new kernel(), name); \
+            registerTypedKernels<kernel, __VA_ARGS__>(device, opType, name);  \
     }
 
-#define REGISTER_KERNEL(device, opType, kernel, name) \
-    _REGISTER_KERNEL_1(device, opType, kernel, name, __COUNTER__)
+// Registers the kernel template `kernel<T>` for every DT<N> index listed,
+// e.g. REGISTER_KERNEL_TYPED(Device::CPU, OpType::Relu, Relu, "relu", 1, 12)
+#define REGISTER_KERNEL_TYPED(device, opType, kernel, name, ...)               \
+    _REGISTER_KERNEL_TYPED_1(device, opType, kernel, name, __COUNTER__,        \
+                             __VA_ARGS__)
@@ -0,0 +1,125 @@
+#pragma once
+#include "core/common.h"
+#include "core/op_type.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace infini {
+
+// Merged view of all runtime metrics at one point in time.
+struct MetricsSnapshot {
+    // Bucket i counts runs faster than 2^i microseconds; the last one
+    // counts the rest.
+    static constexpr size_t NumBuckets = 24;
+
+    struct OpStats {
+        uint64_t calls = 0;
+        uint64_t nanos = 0;
+    };
+
+    uint64_t runs = 0;
+    uint64_t runNanos = 0;
+    std::array<uint64_t, NumBuckets + 1> runLatency{};
+    map<string, OpStats> ops; // By op type name, executed types only
+    uint64_t bytesPlanned = 0;
+    uint64_t fallbackHits = 0;
+
+    // Prometheus text exposition format
+    string toPrometheus() const;
+    string toJson() const;
+};
+
+/**
+ * @brief Process-wide runtime counters: graph runs and their latency
+ * histogram, time per operator type, bytes planned by the allocators and
+ * operators run by a fallback kernel (the default candidate, used untuned
+ * because the plan was compiled before tensors held data).
+ *
+ * Every thread updates its own shard with relaxed atomic stores, so the hot
+ * path takes no lock and shares no cache line with other threads. snapshot()
+ * sums the shards. Shards outlive their threads, so nothing is lost when a
+ * worker exits.
+ */
+class Metrics {
+  public:
+    static constexpr size_t MaxOpTypes = 64;
+
+  private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> runs{0};
+        std::atomic<uint64_t> runNanos{0};
+        std::array<std::atomic<uint64_t>, MetricsSnapshot::NumBuckets + 1>
+            runLatency{};
+        std::array<std::atomic<uint64_t>, MaxOpTypes> opCalls{};
+        std::array<std::atomic<uint64_t>, MaxOpTypes> opNanos{};
+        std::atomic<uint64_t> bytesPlanned{0};
+        std::atomic<uint64_t> fallbackHits{0};
+    };
+
+    std::atomic<bool> enabled{true};
+    std::mutex mtx; // Guards `shards`, taken once per thread and on read
+    vector<std::unique_ptr<Shard>> shards;
+
+  public:
+    static Metrics &getInstance() {
+        static Metrics instance;
+        return instance;
+    }
+
+    // Disabling skips the per-operator clock reads in the runtime.
+    void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    void recordRun(uint64_t nanos);
+    void recordOp(OpType type, uint64_t nanos, bool fallback);
+    void recordBytesPlanned(uint64_t bytes);
+
+    MetricsSnapshot snapshot();
+    // Zeroes all counters. Updates racing with it may survive.
+    void reset();
+
+  private:
+    Shard &local();
+};
+
+/**
+ * @brief Writes Metrics snapshots to a file every `interval` from a
+ * background thread, and once more on destruction. Each write goes to a
+ * temporary file renamed over `path`, so readers such as the Prometheus
+ * node exporter's textfile collector never see a partial file. Failed
+ * background and final writes are reported on stderr; write() throws.
+ */
+class MetricsExporter {
+  public:
+    enum class Format { Prometheus, Json };
+
+  private:
+    string path;
+    Format format;
+    std::chrono::milliseconds interval;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+    std::thread worker;
+
+  public:
+    MetricsExporter(string path, Format format,
+                    std::chrono::milliseconds interval);
+    MetricsExporter(const MetricsExporter &) = delete;
+    MetricsExporter &operator=(const MetricsExporter &) = delete;
+    ~MetricsExporter();
+
+    void write();
+
+  private:
+    // write(), reporting a failure instead of throwing
+    void writeOrReport() noexcept;
+    void loop();
+};
+
+} // namespace infini
@@ -21,7 +21,9 @@ namespace infini
             Div,
             Mul,
             MatMul,
+            QuantizedMatMul,
             Relu,
+            SparseMatMul,
             Sub,
             Transpose,
 
@@ -5,7 +5,7 @@
 
 namespace infini
 {
-    using KernelAttrs = std::tuple<Device, OpType::underlying_t>;
+    using KernelAttrs = std::tuple<Device, OpType::underlying_t, DataType>;
 
     class GraphObj;
     class OperatorObj : public Object
@@ -55,6 +55,18 @@ namespace infini
         virtual int numInputs() const = 0;
         virtual int numOutputs() const = 0;
 
+        /**
+         * @brief Theoretical floating point operations of one execution.
+         * Data movement operators report 0.
+         */
+        virtual uint64_t getFlops() const { return 0; }
+
+        /**
+         * @brief Minimum bytes one execution has to move: every input read
+         * once and every output written once.
+         */
+        virtual uint64_t getBytesMoved() const;
+
         /**
          * @brief Clone this operator and replace its inputs and outputs.
          *
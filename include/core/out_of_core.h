@@ -0,0 +1,81 @@
+#pragma once
+#include "core/graph.h"
+#include "core/plan.h"
+#include <future>
+#include <memory>
+
+namespace infini {
+
+class SpillFile;
+
+/**
+ * @brief Runs a graph whose activations do not fit in memory by spilling
+ * some of them to a scratch file.
+ *
+ * At construction the planner simulates the run step by step. While the
+ * tensors resident at some step exceed `memoryBudget`, it marks spillable the
+ * intermediate that is live there but needed furthest in the future. A
+ * spilled tensor is written out right after its producer runs and is resident
+ * only around its producer and consumers: its buffer is freed one step after
+ * production, once the write has finished, and reallocated and read back one
+ * step before each consumer. An I/O thread does the reads and writes, so they
+ * overlap the kernels of the neighbouring step.
+ *
+ * Graph inputs and outputs stay resident; the executor allocates them unless
+ * they already hold data. Intermediates get their own buffers only while
+ * resident, so do not dataMalloc() the graph.
+ */
+class OutOfCoreExecutor {
+    Graph graph;
+    Plan plan;
+    size_t memoryBudget;
+    std::unique_ptr<SpillFile> file;
+
+    struct TensorInfo {
+        Tensor tensor;
+        size_t producer;          // Step index
+        vector<size_t> consumers; // Step indices, ascending
+        bool spilled = false;
+        size_t fileOffset = 0;
+        void *buffer = nullptr;
+        std::shared_future<void> io; // Pending read or write
+        bool reading = false;
+    };
+    vector<TensorInfo> intermediates;
+    // enter[i] / leave[i]: intermediates becoming resident before step i /
+    // released after step i
+    vector<vector<size_t>> enter, leave;
+    vector<void *> pinned; // Buffers of inputs and outputs we allocated
+    size_t pinnedBytes = 0;
+    size_t plannedPeak = 0;
+    size_t peak = 0, current = 0;
+
+  public:
+    /**
+     * @param graph A topo-sortable graph without allocated intermediates.
+     * @param memoryBudget Bytes of tensor data allowed in memory at once.
+     * @param scratchDir Directory for the scratch file, which is unlinked as
+     * soon as it is opened.
+     */
+    OutOfCoreExecutor(Graph graph, size_t memoryBudget,
+                      const string &scratchDir = "/tmp");
+    OutOfCoreExecutor(const OutOfCoreExecutor &) = delete;
+    OutOfCoreExecutor &operator=(const OutOfCoreExecutor &) = delete;
+    ~OutOfCoreExecutor();
+
+    void run();
+
+    TensorVec getSpilled() const;
+    // Peak of resident tensor bytes the planner expects / the last run saw
+    size_t getPlannedPeakBytes() const { return plannedPeak; }
+    size_t getPeakBytes() const { return peak; }
+
+  private:
+    // Steps at which an intermediate is resident, as closed intervals
+    vector<pair<size_t, size_t>> residency(const TensorInfo &info) const;
+    void planSpills();
+    void acquire(TensorInfo &info);
+    void release(TensorInfo &info);
+};
+
+} // namespace infini
@@ -0,0 +1,90 @@
+#pragma once
+#include "core/graph.h"
+#include "core/plan.h"
+#include "utils/spsc_queue.h"
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace infini {
+
+/**
+ * @brief Streams micro-batches through a graph split into pipeline stages.
+ *
+ * The topologically sorted operators are cut into `numStages` contiguous
+ * stages of roughly equal cost (FLOPs plus bytes moved). Every stage runs on
+ * its own thread, optionally pinned to its own group of CPUs, so stage i can
+ * work on micro-batch j while stage i+1 works on micro-batch j-1. Stages hand
+ * micro-batches on through bounded lock-free queues.
+ *
+ * Up to `depth` micro-batches are in flight. Each one owns a slot: a clone of
+ * every operator bound to the slot's own activation buffers, so no two stages
+ * ever touch the same buffer. Inputs not listed in `microBatchInputs` (e.g.
+ * weights) are shared by all slots and read-only.
+ */
+class PipelineExecutor {
+  public:
+    // One byte buffer per micro-batch input (for requests) or per graph
+    // output (for results), in the order of `microBatchInputs` /
+    // GraphObj::getOutputs().
+    using Sample = vector<vector<uint8_t>>;
+
+  private:
+    struct Slot {
+        OpVec ops; // Clones of the plan steps' operators
+        TensorVec inputs, outputs;
+        void *buffer = nullptr;
+        std::promise<Sample> result;
+        std::exception_ptr error;
+    };
+    struct Stage {
+        size_t begin, end; // Range of plan steps
+        vector<int> cpus;
+        std::thread thread;
+    };
+
+    Graph graph;
+    Plan plan;
+    vector<Slot> slots;
+    vector<Stage> stages;
+    // queues[i] feeds stage i; the last one returns finished slots to submit()
+    vector<std::unique_ptr<SpscQueue<int>>> queues;
+    std::mutex submitMtx; // Makes submit() the single producer of queues[0]
+    bool stopped = false;
+
+  public:
+    /**
+     * @param graph A topo-sortable graph. Inputs other than
+     * `microBatchInputs` must hold data.
+     * @param microBatchInputs Graph inputs that receive a new value with every
+     * micro-batch.
+     * @param numStages Number of pipeline stages, at most the operator count.
+     * @param depth Maximum number of micro-batches in flight.
+     * @param stageCpus Empty, or one group of logical CPUs per stage to pin its
+     * thread to.
+     */
+    PipelineExecutor(Graph graph, TensorVec microBatchInputs, int numStages,
+                     int depth = 2, vector<vector<int>> stageCpus = {});
+    PipelineExecutor(const PipelineExecutor &) = delete;
+    PipelineExecutor &operator=(const PipelineExecutor &) = delete;
+    ~PipelineExecutor();
+
+    /**
+     * @brief Enqueues one micro-batch, waiting while `depth` of them are in
+     * flight. The future holds every graph output, or the exception thrown
+     * while running it.
+     */
+    std::future<Sample> submit(const Sample &inputs);
+
+    // Range [begin, end) of topologically sorted operators in every stage.
+    vector<pair<size_t, size_t>> getStageBounds() const;
+
+  private:
+    void splitStages(size_t numStages);
+    void buildSlot(Slot &slot, const TensorVec &microBatchInputs);
+    void loop(size_t stage);
+    void stop();
+};
+
+} // namespace infini
@@ -0,0 +1,50 @@
+#pragma once
+#include "core/graph.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+/**
+ * @brief A compiled execution plan of a graph: the operators in topological
+ * order, each bound to the kernel that will execute it, and the CPU ISA level
+ * the kernels dispatch to.
+ *
+ * Plans are produced by RuntimeObj::compile() and consumed by
+ * RuntimeObj::execute(). Compiling resolves every kernel up front, so a
+ * missing kernel fails before any operator has run.
+ */
+class PlanObj {
+  public:
+    struct Step {
+        Operator op;
+        Kernel *kernel;
+        string kernelName;
+        // The key has several candidates but none could be timed, so the
+        // default one runs untuned.
+        bool fallback = false;
+    };
+
+  private:
+    Graph graph;
+    vector<Step> steps;
+    CpuIsa isa;
+    // Kernels built for this plan alone, e.g. tiled chains. They run on the
+    // tensor buffers bound when the plan was compiled.
+    vector<std::shared_ptr<Kernel>> ownedKernels;
+
+  public:
+    PlanObj(Graph graph, vector<Step> steps, CpuIsa isa,
+            vector<std::shared_ptr<Kernel>> ownedKernels = {})
+        : graph(std::move(graph)), steps(std::move(steps)), isa(isa),
+          ownedKernels(std::move(ownedKernels)) {}
+
+    const Graph &getGraph() const { return graph; }
+    const vector<Step> &getSteps() const { return steps; }
+    CpuIsa getIsa() const { return isa; }
+    // Whether some steps are tied to the buffers bound at compile time, so
+    // the plan cannot run the same operators on other buffers.
+    bool capturesBuffers() const { return !ownedKernels.empty(); }
+    string toString() const;
+};
+
+} // namespace infini
@@ -0,0 +1,71 @@
+#pragma once
+#include "core/allocator.h"
+#include "core/graph.h"
+#include "core/plan.h"
+#include <memory>
+
+namespace infini {
+
+/**
+ * @brief Compiled plans of one graph, one per signature of input shapes.
+ *
+ * The first activate() for a signature runs shape inference, plans an arena
+ * for it (intermediates share memory once their last consumer has run) and
+ * compiles the plan, so the kernels are selected for those shapes. Every
+ * later activate() of a known signature is a hash lookup plus rebinding the
+ * recorded shape and buffer of each tensor: no shape_infer(), no allocation,
+ * no kernel selection.
+ *
+ * Inputs not listed in `dynamicInputs` (e.g. weights) keep their shape and
+ * data and are shared by every plan. After activate(), the dynamic inputs
+ * point at the buffers of the chosen plan; write the input data then.
+ */
+class PlanCache {
+    struct ShapesHash {
+        size_t operator()(const vector<Shape> &shapes) const {
+            size_t h = 0;
+            for (auto &shape : shapes) {
+                for (auto d : shape)
+                    h = h * 1000003 ^ std::hash<ShapeElem>()(d);
+                h = h * 1000003 ^ shape.size();
+            }
+            return h;
+        }
+    };
+    struct Entry {
+        Plan plan;
+        // Per tensor of the graph, in GraphObj::getTensors() order
+        vector<Shape> shapes;
+        vector<Blob> blobs;
+        std::unique_ptr<Allocator> arena;
+        size_t arenaBytes = 0;
+    };
+
+    Graph graph;
+    TensorVec dynamicInputs;
+    std::unordered_map<vector<Shape>, Entry, ShapesHash> entries;
+    const Entry *active = nullptr;
+
+  public:
+    /**
+     * @param graph A topo-sortable graph whose static inputs hold data.
+     * @param dynamicInputs Graph inputs whose shape varies between runs.
+     */
+    PlanCache(Graph graph, TensorVec dynamicInputs);
+
+    /**
+     * @brief Switches the graph to the plan for these shapes of
+     * `dynamicInputs`, building it on first use, and returns the plan.
+     */
+    Plan activate(const vector<Shape> &inputShapes);
+
+    size_t numPlans() const { return entries.size(); }
+    // Bytes of the arena of the active plan
+    size_t getActiveBytes() const;
+
+  private:
+    Entry build(const vector<Shape> &inputShapes);
+    void bind(const Entry &entry);
+};
+
+} // namespace infini
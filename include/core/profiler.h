@@ -0,0 +1,97 @@
+#pragma once
+#include "core/cpu_info.h"
+#include "core/operator.h"
+#include <chrono>
+#include <thread>
+
+namespace infini {
+
+// Single-thread peaks of this host, see Profiler::calibrate().
+struct MachinePeaks {
+    double gflops = 0;
+    double gbps = 0;
+};
+
+/**
+ * @brief Per-operator profiler for NativeCpuRuntimeObj::execute().
+ *
+ * Around every kernel it reads a perf_event_open counter group (cycles,
+ * instructions, LLC misses, branch misses) and the wall clock, accumulating
+ * the results per operator. When counters cannot be opened (no permission,
+ * no PMU in a VM, non-Linux host) it degrades to wall-clock timing only.
+ *
+ * Counters follow the thread running the kernels and are opened lazily on
+ * it; work a kernel hands to other threads (e.g. OpenMP) is not counted.
+ *
+ * Each operator's getFlops()/getBytesMoved() turn the measured time into
+ * achieved GFLOP/s, GB/s and arithmetic intensity. With machine peaks set the
+ * report also shows the fraction of the roofline bound
+ * min(peak GFLOP/s, intensity * peak GB/s) every operator reaches.
+ */
+class Profiler {
+  public:
+    struct Record {
+        UidBaseType guid;
+        OpType type = OpType::Unknown;
+        string kernelName;
+        size_t calls = 0;
+        double seconds = 0;
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t llcMisses = 0;
+        uint64_t branchMisses = 0;
+        uint64_t flops = 0; // Summed over calls
+        uint64_t bytes = 0;
+
+        double ipc() const { return cycles ? double(instructions) / cycles : 0; }
+        double gflops() const { return seconds > 0 ? flops / seconds / 1e9 : 0; }
+        double gbps() const { return seconds > 0 ? bytes / seconds / 1e9 : 0; }
+        // FLOPs per byte moved
+        double intensity() const { return bytes ? double(flops) / bytes : 0; }
+    };
+
+  private:
+    bool wantCounters;
+    bool counters = false;
+    string unavailableReason;
+    vector<int> fds; // fds[0] is the group leader
+    std::thread::id owner;
+    optional<MachinePeaks> peaks;
+
+    vector<Record> records;
+    std::unordered_map<UidBaseType, size_t> index; // guid -> records
+    std::chrono::steady_clock::time_point beg;
+
+  public:
+    explicit Profiler(bool useCounters = true);
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+    ~Profiler();
+
+    // Whether hardware counters are read; false means wall-clock only.
+    bool hasCounters();
+    const string &getUnavailableReason() const { return unavailableReason; }
+
+    void begin();
+    void end(const Operator &op, const string &kernelName);
+
+    /**
+     * @brief Measures single-thread peak FLOP/s with a register-resident
+     * multiply-add loop of the given ISA level and peak memory bandwidth with
+     * a STREAM-like triad over buffers larger than the last-level cache.
+     * Takes a fraction of a second. The bandwidth is a DRAM figure, so
+     * operators whose data stays in cache can report more than 100%.
+     */
+    static MachinePeaks calibrate(CpuIsa isa = detectCpuIsa());
+    void setPeaks(MachinePeaks peaks) { this->peaks = peaks; }
+
+    const vector<Record> &getRecords() const { return records; }
+    void reset();
+    string report() const;
+
+  private:
+    void openCounters();
+    void closeCounters();
+};
+
+} // namespace infini
@@ -1,7 +1,9 @@
 #pragma once
 #include "core/common.h"
+#include "core/cpu_info.h"
 #include "core/op_type.h"
 #include "core/ref.h"
+#include "core/thread_pool.h"
 
 namespace infini
 {
@@ -10,12 +12,15 @@ namespace infini
   class GraphObj;
   class RuntimeObj;
   class BlobObj;
+  class PlanObj;
+  class Profiler;
 
   using Tensor = Ref<TensorObj>;
   using Operator = Ref<OperatorObj>;
   using Graph = Ref<GraphObj>;
   using Runtime = Ref<RuntimeObj>;
   using Blob = Ref<BlobObj>;
+  using Plan = Ref<PlanObj>;
 
   using TensorVec = vector<Tensor>;
   using OpVec = vector<Operator>;
@@ -38,6 +43,23 @@ namespace infini
     virtual ~RuntimeObj() {}
 
     virtual void run(const Graph &graph) const = 0;
+    /**
+     * @brief Binds every operator of the graph to a kernel. Throws if any
+     * operator has no kernel for this device.
+     */
+    virtual Plan compile(const Graph &graph) const = 0;
+    /**
+     * @brief Throws, listing every operator of the graph without a kernel
+     * for this device, so a bad graph is rejected at load time.
+     */
+    void checkKernels(const Graph &graph) const;
+    virtual void execute(const Plan &plan) const = 0;
+    /**
+     * @brief Runs steps [begin, end) of a plan. execute() is the whole range;
+     * schedulers call this to interleave plans between operators.
+     */
+    virtual void executeSteps(const Plan &plan, size_t begin,
+                              size_t end) const = 0;
     virtual void *alloc(size_t size) = 0;
     virtual void dealloc(void *ptr) = 0;
 
@@ -49,11 +71,46 @@ namespace infini
     virtual string toString() const = 0;
   };
 
+  /**
+   * @brief Runtime executing kernels on the host CPU.
+   *
+   * Every instance owns a thread pool sized and pinned by its CpuPartition,
+   * so several runtimes in one process can each keep to their own cores.
+   * CPUs of an exclusive partition cannot be claimed by any other runtime
+   * while the instance lives. The default partition, CpuPartition::all(),
+   * claims nothing: its workers move off the CPUs exclusive runtimes hold and
+   * back when they are released, keeping their number. The thread calling
+   * execute() is thread 0 of the partition; bindCurrentThread() pins it
+   * accordingly. The WaitPolicy trades idle CPU time of the pool for wake-up
+   * latency, see WaitPolicy::hot() for dedicated cores.
+   */
   class NativeCpuRuntimeObj : public RuntimeObj
   {
+    // ISA level of the kernel variants, detected once when the runtime is
+    // created and recorded in every plan.
+    CpuIsa isa;
+    // Optional, wraps every kernel launched by execute()
+    Ref<Profiler> profiler;
+    CpuPartition partition;
+    std::unique_ptr<ThreadPool> pool;
+    // Depth-first tiling of element-wise chains, see tileChains(); 0 is off
+    size_t tileBytes = 0;
+    // The last tiled plan run() compiled, reused while the graph's operators
+    // and buffers, the tile size and the ISA level stay the same. Tiling
+    // allocates scratch memory and clones every operator per tile, too much
+    // to redo on every run.
+    mutable std::mutex tiledMtx;
+    mutable Plan tiledPlan;
+    mutable vector<const void *> tiledSignature;
+
   public:
-    NativeCpuRuntimeObj() : RuntimeObj(Device::CPU) {}
+    explicit NativeCpuRuntimeObj(
+        CpuPartition partition = CpuPartition::all(),
+        WaitPolicy waitPolicy = WaitPolicy::spinThenPark());
+    ~NativeCpuRuntimeObj();
 
+    // Process-wide default runtime sharing every available CPU. Runtimes
+    // that must keep to their own cores are created directly instead.
     static Ref<NativeCpuRuntimeObj> &getInstance()
     {
       static Ref<NativeCpuRuntimeObj> instance =
@@ -62,8 +119,31 @@ namespace infini
     }
     void dealloc(void *ptr) override;
     void run(const Graph &graph) const override;
+    Plan compile(const Graph &graph) const override;
+    void execute(const Plan &plan) const override;
+    void executeSteps(const Plan &plan, size_t begin,
+                      size_t end) const override;
     void *alloc(size_t size) override;
     string toString() const override;
+
+    CpuIsa getIsa() const { return isa; }
+    // Lowers the ISA level, e.g. to exercise the fallback kernels. Raising it
+    // above what the host supports is rejected.
+    void setIsa(CpuIsa isa);
+
+    void setProfiler(Ref<Profiler> profiler) { this->profiler = profiler; }
+    Ref<Profiler> getProfiler() const { return profiler; }
+
+    // Tile size for depth-first execution of element-wise chains by the
+    // plans compiled from now on, e.g. half the L2 cache. 0 turns it off and
+    // releases the plan run() kept.
+    void setTileBytes(size_t bytes);
+    size_t getTileBytes() const { return tileBytes; }
+
+    const CpuPartition &getPartition() const { return partition; }
+    ThreadPool &getThreadPool() const { return *pool; }
+    // Pins the calling thread to the CPUs of thread 0 of the partition.
+    void bindCurrentThread() const;
   };
 
 } // namespace infini
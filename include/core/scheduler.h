@@ -0,0 +1,84 @@
+#pragma once
+#include "core/graph.h"
+#include "core/plan.h"
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace infini {
+
+/**
+ * @brief Runs requests for several graphs on one runtime, switching between
+ * them at operator granularity.
+ *
+ * Before every operator the scheduler picks the most urgent runnable request:
+ * highest priority first, then earliest deadline (requests without one come
+ * last), then submission order. A latency-critical request submitted while a
+ * long batch job is running therefore waits for at most one operator of that
+ * job. Requests for the same graph share its tensors, so they run one after
+ * another in submission order.
+ *
+ * Deadlines are soft. A request whose deadline passes before its first
+ * operator is dropped with an exception, since its result would be late
+ * anyway; one that has started runs to completion and counts as a miss.
+ */
+class GraphScheduler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        size_t completed = 0;
+        size_t dropped = 0;        // Expired before starting
+        size_t deadlineMisses = 0; // Finished after the deadline
+        size_t preemptions = 0;    // Switches away from a started request
+        size_t opsExecuted = 0;
+    };
+
+  private:
+    struct Request {
+        Plan plan;
+        int priority;
+        optional<Clock::time_point> deadline;
+        size_t seq;
+        size_t next = 0; // Next step to run
+        std::promise<void> done;
+    };
+
+    Runtime runtime;
+    std::mutex mtx;
+    std::condition_variable cv;
+    vector<std::unique_ptr<Request>> requests;
+    size_t nextSeq = 0;
+    bool stopping = false;
+    Stats stats;
+    std::thread worker;
+
+  public:
+    explicit GraphScheduler(Runtime runtime);
+    GraphScheduler(const GraphScheduler &) = delete;
+    GraphScheduler &operator=(const GraphScheduler &) = delete;
+    // Finishes every pending request before returning.
+    ~GraphScheduler();
+
+    /**
+     * @brief Queues one run of `graph`, compiled on the calling thread. The
+     * future becomes ready when the run is done, or holds the exception that
+     * ended it.
+     */
+    std::future<void> submit(const Graph &graph, int priority = 0,
+                             optional<Clock::time_point> deadline = {});
+    std::future<void> submit(const Plan &plan, int priority = 0,
+                             optional<Clock::time_point> deadline = {});
+
+    Stats getStats();
+
+  private:
+    void loop();
+    // Most urgent runnable request, or nullptr. Needs `mtx`.
+    Request *pick();
+    void finish(Request *req, std::exception_ptr error);
+};
+
+} // namespace infini
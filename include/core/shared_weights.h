@@ -0,0 +1,58 @@
+#pragma once
+#include "core/tensor.h"
+
+namespace infini {
+
+/**
+ * @brief Constant tensors stored once in a named POSIX shared-memory segment
+ * and mapped by every worker process of a host.
+ *
+ * One process publish()es the tensors: the segment is created, filled with
+ * their data and the tensors are rebound to it. The other processes build the
+ * same graph and attach() to the segment by name; their tensors are bound to
+ * a read-only mapping of it, so N workers hold the weights once instead of N
+ * times. The segment records the data type and shape of every tensor, and
+ * attach() rejects tensors that do not match.
+ *
+ * Blobs pointing into the segment keep the mapping alive. The name stays
+ * valid for later attach() calls until remove() is called, independently of
+ * any mapping.
+ */
+class SharedWeights {
+    string name;
+    void *base;
+    size_t bytes;
+
+    SharedWeights(string name, void *base, size_t bytes)
+        : name(std::move(name)), base(base), bytes(bytes) {}
+
+  public:
+    SharedWeights(const SharedWeights &) = delete;
+    SharedWeights &operator=(const SharedWeights &) = delete;
+    ~SharedWeights();
+
+    /**
+     * @brief Creates segment `name` (e.g. "/model-weights"), copies the data
+     * of `tensors` into it and rebinds them to it. Fails if the name is
+     * taken or a tensor has no data.
+     */
+    static Ref<SharedWeights> publish(const string &name,
+                                      const TensorVec &tensors);
+    /**
+     * @brief Maps segment `name` read-only and binds `tensors`, in the order
+     * they were published, to their data in it.
+     */
+    static Ref<SharedWeights> attach(const string &name,
+                                     const TensorVec &tensors);
+    // Removes the name; existing mappings stay valid
+    static void remove(const string &name);
+
+    const string &getName() const { return name; }
+    size_t getBytes() const { return bytes; }
+
+  private:
+    static void bind(const Ref<SharedWeights> &segment,
+                     const TensorVec &tensors);
+};
+
+} // namespace infini
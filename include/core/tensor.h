@@ -39,6 +39,10 @@ namespace infini
         
         Runtime runtime; // 数据存在哪里？(CPU, CUDA)
 
+        // 数据版本号：每次数据被改写（setData、重新绑定 Blob、bumpVersion）时递增，
+        // 供增量执行判断输入是否变化
+        mutable uint64_t version = 0;
+
     private:
         Shape shape; // 具体的形状，比如 [batch, channel, height, width]
         size_t _size; // 元素总个数缓存 (Cache of Π(shape))，比如 2*3=6
@@ -70,6 +74,7 @@ namespace infini
         // 绑定实际的内存块 (Blob)
         // 通常在 dataMalloc 阶段调用，确立物理地址。
         void setDataBlob(const Blob &blob);
+        Blob getDataBlob() const { return data; }
 
         // 打印数据内容 (Debug 用)
         void printData() const;
@@ -95,6 +100,14 @@ namespace infini
             return data->getPtr<T>();
         }
 
+        // Writers going through getRawDataPtr() must call bumpVersion() so
+        // incremental execution sees the change
+        uint64_t getVersion() const { return version; }
+        void bumpVersion() const { ++version; }
+
+        // 是否已经绑定了实际内存（dataMalloc 之后为 true）
+        bool hasData() const { return data != nullptr; }
+
         DataType getDType() const { return dtype; }
         Runtime getRuntime() const { return runtime; }
 
@@ -0,0 +1,121 @@
+#pragma once
+#include "core/common.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace infini {
+
+/**
+ * @brief How idle workers, and a caller waiting for them, wait for the next
+ * event.
+ *
+ * A waiter first spins on the pool state for `spin`, then yields its CPU
+ * between checks for `yield`, and finally parks on a condition variable.
+ * Parking costs a futex wake-up of tens of microseconds per parallel
+ * region, which dominates graphs of many tiny operators; spinning keeps
+ * that latency down at the price of CPU time while idle. Hot never parks,
+ * for cores dedicated to inference. With more threads than CPUs a spinning
+ * waiter would keep the CPU from the thread it waits for, so pools in that
+ * situation yield where they would spin.
+ */
+struct WaitPolicy {
+    enum class Mode { Park, Hot };
+    Mode mode = Mode::Park;
+    std::chrono::microseconds spin{0}, yield{0};
+
+    // Park right away, the behaviour of a plain condition variable
+    static WaitPolicy sleep() { return {}; }
+    static WaitPolicy
+    spinThenPark(std::chrono::microseconds spin = std::chrono::microseconds(50),
+                 std::chrono::microseconds yield = std::chrono::microseconds(
+                     200)) {
+        return {Mode::Park, spin, yield};
+    }
+    static WaitPolicy hot() { return {Mode::Hot, {}, {}}; }
+};
+
+/**
+ * @brief Fixed set of worker threads a runtime runs parallel kernel loops on.
+ *
+ * A pool of n threads owns n - 1 workers; the thread calling parallelFor()
+ * takes the first range itself. Workers are pinned once when they start, see
+ * CpuPartition. A parallelFor() issued while the pool is busy (from another
+ * thread, or nested inside a range) runs inline on the caller instead of
+ * waiting. Workers and the caller wait according to the WaitPolicy.
+ */
+class ThreadPool {
+    const WaitPolicy policy;
+    bool oversubscribed;
+    std::mutex dispatchMtx; // Held for the duration of one parallelFor()
+    // Guards parking and `error`; the hand-off itself is lock-free
+    std::mutex mtx;
+    std::condition_variable wake, done;
+    vector<std::thread> workers;
+    // Published by the caller to start a job, after the job fields below:
+    // a sequence number above 16 bits for the number of chunks, so a worker
+    // reads both at once
+    alignas(64) std::atomic<uint64_t> ticket{0};
+    alignas(64) std::atomic<size_t> pending{0};
+    std::atomic<bool> stopping{false};
+    // Threads parked on `wake` / `done`; a notifier takes the mutex only if
+    // someone is parked
+    std::atomic<int> parkedWorkers{0}, parkedCaller{0};
+
+    // The job of the current generation, valid while pending > 0
+    const std::function<void(size_t, size_t)> *job = nullptr;
+    size_t jobSize = 0, jobChunks = 0;
+    std::exception_ptr error;
+
+  public:
+    /**
+     * @param numThreads Threads including the caller, at least 1.
+     * @param workerCpus Empty, or one CPU group per worker to pin it to.
+     */
+    ThreadPool(int numThreads, const vector<vector<int>> &workerCpus = {},
+               WaitPolicy policy = WaitPolicy::spinThenPark());
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    int getNumThreads() const { return workers.size() + 1; }
+    // Pins every worker to `cpus` from now on, as far as the OS allows
+    void pinWorkers(const vector<int> &cpus) noexcept;
+    const WaitPolicy &getWaitPolicy() const { return policy; }
+
+    /**
+     * @brief Splits [0, n) into contiguous ranges of at least `grain`
+     * iterations, at most one per thread, and calls fn(begin, end) on each.
+     * Returns when all ranges are done; rethrows the first exception.
+     */
+    void parallelFor(size_t n, const std::function<void(size_t, size_t)> &fn,
+                     size_t grain = 1);
+
+  private:
+    void shutdown();
+    // Waits per the policy until `ready` holds, parking on `cv` with
+    // `parked` raised
+    template <typename Pred>
+    void await(Pred ready, std::condition_variable &cv,
+               std::atomic<int> &parked);
+    void notify(std::condition_variable &cv, std::atomic<int> &parked);
+    void loop(size_t worker);
+    void runChunk(size_t chunk);
+};
+
+class RuntimeObj;
+/**
+ * @brief parallelFor() on the thread pool of `context` if it has one,
+ * otherwise a single call fn(0, n) on the caller.
+ */
+void parallelFor(const RuntimeObj *context, size_t n,
+                 const std::function<void(size_t, size_t)> &fn,
+                 size_t grain = 1);
+
+// Threads parallelFor(context, ...) may use, 1 without a thread pool
+int getParallelism(const RuntimeObj *context);
+
+} // namespace infini
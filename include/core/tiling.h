@@ -0,0 +1,27 @@
+#pragma once
+#include "core/plan.h"
+
+namespace infini {
+
+/**
+ * @brief Rewrites chains of element-wise and unary steps so that each chain
+ * runs depth-first, tile by tile, instead of operator by operator.
+ *
+ * A chain is a run of consecutive Add/Sub/Mul/Div/Relu/Clip steps with the
+ * same output shape and data type, each consuming a result of the one before.
+ * The output is cut into contiguous tiles of about `tileBytes` along its
+ * outermost axes, and every tile passes through the whole chain before the
+ * next one starts. Intermediates read only inside the chain live in a
+ * scratch buffer of one tile each, so they stay in cache instead of going
+ * through DRAM. Inputs of the chain are sliced the same way, except operands
+ * broadcast along the tiled axes, which are read whole.
+ *
+ * No fused kernel is involved: every tile runs clones of the operators, with
+ * the kernels the plan had already selected. The chain becomes one step whose
+ * kernel is owned by the returned plan, so the plan is bound to the buffers
+ * the graph holds now, see PlanObj::capturesBuffers(). Chains whose tensors
+ * have no data yet are left alone.
+ */
+Plan tileChains(const Plan &plan, size_t tileBytes);
+
+} // namespace infini
@@ -0,0 +1,84 @@
+#pragma once
+#include "core/cpu_info.h"
+#include "core/plan.h"
+#include "core/runtime.h"
+#include <map>
+
+namespace infini {
+
+/**
+ * @brief A recorded run of a plan, self-contained enough to rebuild and rerun
+ * its operators without the program that produced it.
+ *
+ * For every tensor the trace keeps the data type, shape and offset of its
+ * buffer (relative to the lowest buffer of the graph), and optionally a
+ * snapshot of the graph inputs. For every step it keeps the operator type
+ * and attributes, the tensors it reads and writes, the kernel that ran and
+ * how long it took. save() writes a compact binary file, load() reads it.
+ */
+struct Trace {
+    struct TensorRecord {
+        DataType dtype;
+        Shape dims;
+        int64_t offset = -1; // -1: no buffer
+        vector<uint8_t> snapshot; // Empty unless recorded
+    };
+    struct StepRecord {
+        OpType type = OpType::Unknown;
+        // Operator attributes, see the encoding in trace.cc
+        vector<int64_t> attrs;
+        vector<uint32_t> inputs, outputs; // Indices into `tensors`
+        string kernelName;
+        uint64_t nanos = 0;
+    };
+
+    CpuIsa isa = CpuIsa::Scalar;
+    int32_t numThreads = 1;
+    vector<TensorRecord> tensors;
+    vector<StepRecord> steps;
+
+    /**
+     * @brief Executes `plan` once on `runtime`, timing every step. With
+     * `snapshotInputs` the data of the graph inputs is copied before the run.
+     * Plans with merged steps (see tileChains()) cannot be traced.
+     */
+    static Trace record(const Ref<NativeCpuRuntimeObj> &runtime,
+                        const Plan &plan, bool snapshotInputs = false);
+
+    void save(const string &path) const;
+    static Trace load(const string &path);
+
+    /**
+     * @brief Builds a graph of the traced tensors and operators on
+     * `runtime`, allocates it and restores the input snapshots. Tensors are
+     * in trace order, operators in step order.
+     */
+    Graph rebuild(Runtime runtime) const;
+};
+
+/**
+ * @brief Reruns a trace, or one step of it, under other kernels or thread
+ * counts.
+ */
+struct ReplayOptions {
+    // Only this step, after running the ones before it once untimed
+    optional<size_t> step;
+    // Kernel to use per operator type name (e.g. "Add" -> "addStrided_CPU").
+    // Other steps keep the kernel of the trace when it exists.
+    std::map<string, string> kernels;
+    int repeat = 1;
+};
+
+struct ReplayResult {
+    // Per replayed step, the fastest of `repeat` runs
+    vector<size_t> steps;
+    vector<string> kernelNames;
+    vector<uint64_t> nanos;
+    Graph graph;
+};
+
+ReplayResult replayTrace(const Trace &trace,
+                         const Ref<NativeCpuRuntimeObj> &runtime,
+                         const ReplayOptions &options = {});
+
+} // namespace infini
@@ -0,0 +1,59 @@
+#pragma once
+#include "core/kernel.h"
+#include <mutex>
+
+namespace infini {
+
+/**
+ * @brief Picks the fastest of several candidate kernels registered for one
+ * KernelAttrs key by timing them on the operator's actual tensors.
+ *
+ * Winners are cached per (op type, dtype, shapes, ISA level, threads) in
+ * memory and, if a cache file is set, persisted there as one
+ * `key<TAB>kernel name` line per key so that later processes on the same
+ * host skip the benchmark.
+ */
+class KernelTuner {
+    using KernelRecord = KernelRegistry::KernelRecord;
+
+    std::mutex mtx;
+    string cacheFile;
+    map<string, string> cache; // tuning key -> kernel name
+    int warmupRounds = 1;
+    int timingRounds = 3;
+
+  public:
+    static KernelTuner &getInstance() {
+        static KernelTuner instance;
+        return instance;
+    }
+
+    /**
+     * @brief Sets the tuning cache file and loads the entries it holds. New
+     * winners are merged into it. An empty path disables persistence.
+     */
+    void setCacheFile(const string &path);
+    void setRounds(int warmup, int timing);
+    // Drops the in-memory cache. The cache file is left untouched.
+    void clear();
+
+    /**
+     * @brief Returns the candidate to run `op` with. Benchmarks all candidates
+     * unless the key is cached. Without allocated data nothing can be timed,
+     * so the default (first) candidate is returned and nothing is cached.
+     */
+    const KernelRecord &select(const Operator &op,
+                               const vector<KernelRecord> &candidates,
+                               const RuntimeObj *context);
+
+    optional<string> lookup(const string &key);
+    // The kernels run at the ISA level and thread count of `context`, and
+    // the fastest one depends on both
+    static string getKey(const Operator &op, const RuntimeObj *context);
+
+  private:
+    void load();
+    void store(const string &key, const string &name);
+};
+
+} // namespace infini
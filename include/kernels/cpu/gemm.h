@@ -0,0 +1,63 @@
+#pragma once
+#include "core/cpu_info.h"
+#include <cstdint>
+
+namespace infini {
+
+/**
+ * @brief Single-precision GEMM on row-major matrices:
+ * C[m x n] = op(A)[m x k] * op(B)[k x n], with op(X) = X^T when the trans
+ * flag is set. `lda`, `ldb` and `ldc` are the row strides of the stored A, B
+ * and C, so A is m x k (k x m if transposed) with rows lda apart.
+ *
+ * The product is computed in cache-sized blocks: a kc x nc panel of op(B) and
+ * an mc x kc block of op(A) are packed into the layout the micro-kernel
+ * streams through, reading straight from the strided source, so no
+ * transposed copy of either operand is ever made. The micro-kernel keeps an
+ * mr x nr tile of C in SIMD registers (8x32 with AVX-512, 6x16 with AVX2).
+ * Small shapes (m <= 64, n and k each 4, 8, 12, 16, 24, 32, 48 or 64) skip
+ * the blocking and run a kernel specialized for n and k at compile time,
+ * with the loop over k fully unrolled. Runs on the calling thread.
+ */
+void sgemm(CpuIsa isa, bool transA, bool transB, size_t m, size_t n,
+           size_t k, const float *A, size_t lda, const float *B, size_t ldb,
+           float *C, size_t ldc);
+
+/**
+ * @brief Single-precision vector-matrix product y[n] = x[k] * op(W), where
+ * op(W) is k x n: W is stored k x n, or n x k when `transW`, with rows `ldw`
+ * apart. x and y are contiguous.
+ *
+ * W is streamed exactly once and nothing is packed, which is what a product
+ * with one row (decoding steps) needs: it is bound by memory bandwidth, not
+ * arithmetic. Threads split the work by output columns, each calling sgemv()
+ * on its slice of W and y. Runs on the calling thread.
+ */
+void sgemv(CpuIsa isa, bool transW, size_t n, size_t k, const float *x,
+           const float *W, size_t ldw, float *y);
+
+// 16-bit floating-point storage of a weight operand
+enum class HalfType { Float16, BFloat16 };
+
+/**
+ * @brief sgemm() with B stored as 16-bit floats. Each panel of op(B) is
+ * widened to fp32 while it is packed (with F16C where the host has it), so
+ * the micro-kernels and the fp32 accumulation are those of sgemm().
+ */
+void sgemm(CpuIsa isa, bool transA, bool transB, size_t m, size_t n,
+           size_t k, const float *A, size_t lda, const uint16_t *B,
+           HalfType bType, size_t ldb, float *C, size_t ldc);
+
+/**
+ * @brief sgemv() with W stored as 16-bit floats. W is still streamed once,
+ * at half the bytes: each vector is widened in registers (with F16C where
+ * the host has it) right before it is multiplied, and y accumulates in fp32.
+ */
+void sgemv(CpuIsa isa, bool transW, size_t n, size_t k, const float *x,
+           const uint16_t *W, HalfType wType, size_t ldw, float *y);
+
+// Widens n contiguous 16-bit floats to fp32
+void widenHalf(CpuIsa isa, HalfType type, const uint16_t *src, float *dst,
+               size_t n);
+
+} // namespace infini
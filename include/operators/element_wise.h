@@ -28,6 +28,8 @@ namespace infini
     std::string toString() const override;
     int numInputs() const override { return 2; }
     int numOutputs() const override { return 1; }
+    // One operation per output element
+    uint64_t getFlops() const override { return outputs[0]->size(); }
     };
 
 #define DEFINE_ELEMENT_WISE_OBJ(prefix, type)                    \
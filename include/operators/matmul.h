@@ -55,6 +55,12 @@ namespace infini
         int getM() const { return m; }
         int getN() const { return n; }
         int getK() const { return k; }
+
+        // A multiply and an add per (output element, k)
+        uint64_t getFlops() const override
+        {
+            return 2 * uint64_t(outputs[0]->size()) * k;
+        }
     };
 
 } // namespace infini
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini
+{
+    /**
+     * @brief Matrix multiplication of int8 activations by int8 weights with
+     * per-output-channel quantization.
+     *
+     * Real values are recovered as scale * (q - zeroPoint): activations with
+     * one scale and zero point, weights with one per output column. Products
+     * are accumulated in int32, then the output is dequantized to Float32 or
+     * requantized to Int8 with its own scale and zero point.
+     *
+     * The CPU kernel packs B once and reuses the packing while B keeps its
+     * blob, shape and contents, so B may be updated in place between runs.
+     * Checking the contents costs one read of B per run. A B computed by
+     * another operator is packed on every run.
+     */
+    class QuantizedMatmulObj : public OperatorObj
+    {
+    private:
+        float scaleA;
+        int zeroA;
+        DataType outputType;
+        // Output quantization, used when outputType is Int8
+        float scaleC;
+        int zeroC;
+
+        // Auxiliary attributes which are not a part of operator attributes.
+        int m, n, k;
+
+    public:
+        /**
+         * @param graph The computation graph that this operator belongs to.
+         * @param A Int8 activations of shape [..., M, K].
+         * @param B Int8 weights of shape [K, N], shared by all batches of A.
+         * @param scales Float32 weight scales of shape [N].
+         * @param zeroPoints Int8 weight zero points of shape [N].
+         * @param C Output of shape [..., M, N], or an empty Ref to create it.
+         * @param scaleA Scale of the activations.
+         * @param zeroA Zero point of the activations, in [-128, 127].
+         * @param outputType Float32 to dequantize, Int8 to requantize.
+         * @param scaleC Scale of an Int8 output.
+         * @param zeroC Zero point of an Int8 output, in [-128, 127].
+         */
+        QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor scales,
+                           Tensor zeroPoints, Tensor C, float scaleA,
+                           int zeroA,
+                           DataType outputType = DataType::Float32,
+                           float scaleC = 1.f, int zeroC = 0);
+        OP_CLONE(QuantizedMatmulObj);
+
+        std::string toString() const override;
+        optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+        vector<DataType> inferDataType(const TensorVec &inputs) const override;
+
+        int numInputs() const override { return 4; }
+        int numOutputs() const override { return 1; }
+
+        float getScaleA() const { return scaleA; }
+        int getZeroA() const { return zeroA; }
+        DataType getOutputType() const { return outputType; }
+        float getScaleC() const { return scaleC; }
+        int getZeroC() const { return zeroC; }
+        int getM() const { return m; }
+        int getN() const { return n; }
+        int getK() const { return k; }
+
+        // A multiply and an add per (output element, k)
+        uint64_t getFlops() const override
+        {
+            return 2 * uint64_t(outputs[0]->size()) * k;
+        }
+    };
+
+} // namespace infini
@@ -0,0 +1,78 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini
+{
+    /**
+     * @brief Storage formats of a sparse weight matrix. Blocks are named
+     * outputs x inputs, as in a [N, K] weight: Block8x1 holds 8 output
+     * channels of one input, Block4x4 a 4 x 4 tile, CSR single values.
+     */
+    enum class SparseFormat
+    {
+        CSR,
+        Block4x4,
+        Block8x1,
+    };
+
+    // Inputs (K) and outputs (N) spanned by one block of `format`
+    int sparseBlockK(SparseFormat format);
+    int sparseBlockN(SparseFormat format);
+    std::string sparseFormatToString(SparseFormat format);
+
+    /**
+     * @brief Matrix multiplication of Float32 activations by a constant
+     * sparse weight B[K, N], of which only the nonzero blocks are stored.
+     *
+     * The N outputs are split into groups of blockN and B is stored as CSR
+     * over the groups: the stored blocks of group g are rowPtr[g] up to
+     * rowPtr[g + 1], block b spans inputs colIndices[b] * blockK onward, and
+     * its blockK x blockN values are input-major, so the outputs of one
+     * input are contiguous. CSR is the 1 x 1 case. See utils/sparse_weight.h
+     * to build these tensors from a dense B.
+     */
+    class SparseMatmulObj : public OperatorObj
+    {
+    private:
+        SparseFormat format;
+
+        // Auxiliary attributes which are not a part of operator attributes.
+        int m, n, k;
+
+    public:
+        /**
+         * @param graph The computation graph that this operator belongs to.
+         * @param A Float32 activations of shape [..., M, K], K a multiple of
+         * the block's inputs.
+         * @param values Float32 stored blocks, [blocks, blockK, blockN].
+         * @param colIndices Int32 input-block index of each block, [blocks].
+         * @param rowPtr Int32 block ranges of the N / blockN output groups,
+         * [N / blockN + 1].
+         * @param C Output of shape [..., M, N], or an empty Ref to create it.
+         * @param format Layout of the blocks.
+         */
+        SparseMatmulObj(GraphObj *graph, Tensor A, Tensor values,
+                        Tensor colIndices, Tensor rowPtr, Tensor C,
+                        SparseFormat format);
+        OP_CLONE(SparseMatmulObj);
+
+        std::string toString() const override;
+        optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+
+        int numInputs() const override { return 4; }
+        int numOutputs() const override { return 1; }
+
+        SparseFormat getFormat() const { return format; }
+        int getM() const { return m; }
+        int getN() const { return n; }
+        int getK() const { return k; }
+
+        // A multiply and an add per stored weight and row of A
+        uint64_t getFlops() const override
+        {
+            size_t rows = n ? outputs[0]->size() / n : 0;
+            return 2 * uint64_t(rows) * inputs[1]->size();
+        }
+    };
+
+} // namespace infini
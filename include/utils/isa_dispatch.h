@@ -0,0 +1,65 @@
+#pragma once
+#include "core/cpu_info.h"
+#include "core/runtime.h"
+
+namespace infini {
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IT_TARGET_SSE4 __attribute__((target("sse4.1,sse4.2")))
+#define IT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define IT_TARGET_AVX512                                                       \
+    __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma")))
+#else
+#define IT_TARGET_SSE4
+#define IT_TARGET_AVX2
+#define IT_TARGET_AVX512
+#endif
+#define IT_ALWAYS_INLINE inline __attribute__((always_inline))
+
+/**
+ * @brief Function table with one entry per CpuIsa level. get() returns the
+ * best variant not above the requested level, so a host always lands on a
+ * variant it can execute.
+ */
+template <typename Fn> class IsaDispatch {
+    Fn variants[4];
+
+  public:
+    constexpr IsaDispatch(Fn scalar, Fn sse4, Fn avx2, Fn avx512)
+        : variants{scalar, sse4, avx2, avx512} {}
+
+    Fn get(CpuIsa isa) const {
+        for (int i = static_cast<int>(isa); i > 0; --i)
+            if (variants[i])
+                return variants[i];
+        return variants[0];
+    }
+};
+
+/**
+ * @brief Compiles `body` (an IT_ALWAYS_INLINE function) once per ISA level and
+ * collects the copies in an IsaDispatch named `name`. The body is inlined into
+ * each target-attributed wrapper, so the compiler vectorizes it for that
+ * level even though the build itself targets baseline x86-64.
+ *
+ * Example:
+ *   IT_DEFINE_ISA_VARIANTS(reluF32, reluBody, void,
+ *                          (const float *x, float *y, size_t n), (x, y, n))
+ */
+#define IT_DEFINE_ISA_VARIANTS(name, body, ret, params, args)                 \
+    static ret name##_scalar params { return body args; }                     \
+    IT_TARGET_SSE4 static ret name##_sse4 params { return body args; }        \
+    IT_TARGET_AVX2 static ret name##_avx2 params { return body args; }        \
+    IT_TARGET_AVX512 static ret name##_avx512 params { return body args; }    \
+    static const IsaDispatch<ret(*) params> name{                             \
+        name##_scalar, name##_sse4, name##_avx2, name##_avx512};
+
+// The ISA level kernels should use under `context`. It is chosen once when
+// the runtime is created and recorded in every plan it compiles.
+inline CpuIsa getContextIsa(const RuntimeObj *context) {
+    if (auto cpu = dynamic_cast<const NativeCpuRuntimeObj *>(context))
+        return cpu->getIsa();
+    return CpuIsa::Scalar;
+}
+
+} // namespace infini
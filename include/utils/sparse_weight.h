@@ -0,0 +1,42 @@
+#pragma once
+#include "core/graph.h"
+#include "operators/sparse_matmul.h"
+
+namespace infini {
+
+/**
+ * @brief A weight B[k, n] stored in one of the SparseFormat layouts: the
+ * values, colIndices and rowPtr inputs of a SparseMatmulObj.
+ */
+struct SparseWeight {
+    SparseFormat format = SparseFormat::CSR;
+    int k = 0, n = 0;
+    vector<int32_t> rowPtr;     // n / blockN + 1 block ranges
+    vector<int32_t> colIndices; // Input block of each stored block
+    vector<float> values;       // blockK x blockN per block, input-major
+
+    size_t blocks() const { return colIndices.size(); }
+    // Bytes of the three arrays, against 4 * k * n stored densely
+    size_t bytes() const;
+};
+
+// Stores every block of the row-major B[k, n] that holds a nonzero. k and n
+// must be multiples of the block's inputs and outputs.
+SparseWeight toSparse(const float *B, int k, int n, SparseFormat format);
+
+/**
+ * @brief Picks the layout of B[k, n] from its measured sparsity: counts the
+ * blocks each format would store and compares their estimated cost with
+ * that of a dense MatMul, for `rows` rows of A per call (1 for decoding).
+ * Returns nullopt when dense is estimated faster. Formats whose blocks do
+ * not tile k x n are not considered.
+ */
+optional<SparseFormat> chooseSparseFormat(const float *B, int k, int n,
+                                          int rows = 1);
+
+// Adds the values, colIndices and rowPtr tensors of `w` to `g`
+TensorVec addSparseWeight(const Graph &g, const SparseWeight &w);
+// Fills tensors from addSparseWeight() with `w`, after g->dataMalloc()
+void copySparseWeight(const TensorVec &tensors, const SparseWeight &w);
+
+} // namespace infini
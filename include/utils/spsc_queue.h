@@ -0,0 +1,64 @@
+#pragma once
+#include "core/common.h"
+#include <atomic>
+#include <thread>
+
+namespace infini {
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer and one consumer
+ * thread. push()/pop() never block; the *Wait variants spin, yielding the
+ * core between attempts.
+ */
+template <typename T> class SpscQueue {
+    // Head and tail live on separate cache lines so the two threads do not
+    // false-share them.
+    alignas(64) std::atomic<size_t> head{0}; // Next slot to pop
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot to push
+    alignas(64) vector<T> ring;
+    size_t mask;
+
+  public:
+    // Holds at least `capacity` elements.
+    explicit SpscQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity + 1)
+            n <<= 1;
+        ring.resize(n);
+        mask = n - 1;
+    }
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    bool push(const T &value) {
+        auto t = tail.load(std::memory_order_relaxed);
+        if (((t + 1) & mask) == head.load(std::memory_order_acquire))
+            return false; // full
+        ring[t] = value;
+        tail.store((t + 1) & mask, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &value) {
+        auto h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false; // empty
+        value = ring[h];
+        head.store((h + 1) & mask, std::memory_order_release);
+        return true;
+    }
+
+    void pushWait(const T &value) {
+        while (!push(value))
+            std::this_thread::yield();
+    }
+
+    T popWait() {
+        T value;
+        while (!pop(value))
+            std::this_thread::yield();
+        return value;
+    }
+};
+
+} // namespace infini
@@ -1,4 +1,5 @@
 #include "core/allocator.h"
+#include <algorithm>
 #include <utility>
 
 namespace infini
@@ -7,6 +8,7 @@ namespace infini
     {
         used = 0;
         peak = 0;
+        highWater = 0;
         ptr = nullptr;
 
         // 'alignment' defaults to sizeof(uint64_t), because it is the length of
@@ -59,6 +61,7 @@ namespace infini
         size_t new_addr = this->peak;
         this->peak += size;
         this->used += size;
+        this->highWater = std::max(this->highWater, this->peak);
 
         return new_addr;
     }
@@ -113,8 +116,9 @@ namespace infini
             // 在 alloc() 阶段，我们实际上并没有真的去买内存，只是在纸上（offset）画地盘。
             // 只有当真的需要用到指针时（调用 getPtr），我们才根据之前记录的 peak（峰值大小），
             // 一次性向系统申请一整块足够大的内存。
-            this->ptr = runtime->alloc(this->peak);
-            printf("Allocator really alloc: %p %lu bytes\n", this->ptr, peak);
+            this->ptr = runtime->alloc(this->highWater);
+            printf("Allocator really alloc: %p %lu bytes\n", this->ptr,
+                   highWater);
         }
         return this->ptr;
     }
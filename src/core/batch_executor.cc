@@ -0,0 +1,115 @@
+#include "core/batch_executor.h"
+
+namespace infini {
+
+BatchExecutor::BatchExecutor(Graph graph, TensorVec batchInputs, int maxBatch,
+                             std::chrono::microseconds timeout)
+    : graph(graph), batchInputs(std::move(batchInputs)), maxBatch(maxBatch),
+      timeout(timeout) {
+    IT_ASSERT(maxBatch >= 1);
+    IT_ASSERT(this->graph->topo_sort() == true);
+    for (auto &input : this->batchInputs) {
+        IT_ASSERT(input->getRank() >= 1 &&
+                      input->getDims()[0] == maxBatch,
+                  "Batched input must have maxBatch as its leading dim");
+        sampleBytes.emplace_back(input->getBytes() / maxBatch);
+    }
+    worker = std::thread([this] { loop(); });
+}
+
+BatchExecutor::~BatchExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+std::future<BatchExecutor::Sample> BatchExecutor::submit(Sample inputs) {
+    IT_ASSERT(inputs.size() == batchInputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+        IT_ASSERT(inputs[i].size() == sampleBytes[i],
+                  "Sample " + std::to_string(i) + " has " +
+                      std::to_string(inputs[i].size()) + " bytes, expected " +
+                      std::to_string(sampleBytes[i]));
+    Request req{std::move(inputs), {}, std::chrono::steady_clock::now()};
+    auto fut = req.result.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        IT_ASSERT(!stopping);
+        queue.emplace_back(std::move(req));
+    }
+    cv.notify_one();
+    return fut;
+}
+
+size_t BatchExecutor::numBatches() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return nBatches;
+}
+
+void BatchExecutor::loop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty())
+            return; // stopping and drained
+        // Wait until the batch is full or the oldest request times out.
+        // Pending requests are still flushed when stopping.
+        auto deadline = queue.front().arrival + timeout;
+        cv.wait_until(lock, deadline, [this] {
+            return stopping || (int)queue.size() >= maxBatch;
+        });
+
+        vector<Request> batch;
+        while (!queue.empty() && (int)batch.size() < maxBatch) {
+            batch.emplace_back(std::move(queue.front()));
+            queue.pop_front();
+        }
+        ++nBatches;
+        lock.unlock();
+        runBatch(batch);
+        lock.lock();
+    }
+}
+
+void BatchExecutor::runBatch(vector<Request> &batch) {
+    int n = batch.size();
+    try {
+        for (auto &input : batchInputs) {
+            auto dims = input->getDims();
+            dims[0] = n;
+            input->setShape(dims);
+        }
+        graph->shape_infer();
+
+        for (size_t i = 0; i < batchInputs.size(); ++i) {
+            auto dst = batchInputs[i]->getRawDataPtr<uint8_t *>();
+            for (int b = 0; b < n; ++b)
+                std::memcpy(dst + b * sampleBytes[i],
+                            batch[b].inputs[i].data(), sampleBytes[i]);
+        }
+
+        graph->getRuntime()->run(graph);
+
+        auto outputs = graph->getOutputs();
+        vector<Sample> results(n, Sample(outputs.size()));
+        for (size_t o = 0; o < outputs.size(); ++o) {
+            IT_ASSERT(outputs[o]->getRank() >= 1 &&
+                          outputs[o]->getDims()[0] == n,
+                      "Graph output does not carry the batch dimension");
+            auto bytes = outputs[o]->getBytes() / n;
+            auto src = outputs[o]->getRawDataPtr<uint8_t *>();
+            for (int b = 0; b < n; ++b)
+                results[b][o].assign(src + b * bytes, src + (b + 1) * bytes);
+        }
+        for (int b = 0; b < n; ++b)
+            batch[b].result.set_value(std::move(results[b]));
+    } catch (...) {
+        for (auto &req : batch)
+            req.result.set_exception(std::current_exception());
+    }
+}
+
+} // namespace infini
@@ -0,0 +1,192 @@
+#include "core/cpu_info.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#ifdef __linux__
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace infini {
+
+#if defined(__x86_64__) || defined(__i386__)
+static uint64_t readXcr0() {
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((uint64_t)edx << 32) | eax;
+}
+
+static CpuFeatures detectFeatures() {
+    CpuFeatures f;
+    unsigned a, b, c, d;
+    if (!__get_cpuid(1, &a, &b, &c, &d))
+        return f;
+    f.sse41 = c & (1u << 19);
+    f.sse42 = c & (1u << 20);
+    bool osxsave = c & (1u << 27);
+    // AVX state is usable only if the OS saves the YMM (and ZMM) registers
+    uint64_t xcr0 = osxsave ? readXcr0() : 0;
+    bool ymm = (xcr0 & 0x6) == 0x6;
+    bool zmm = (xcr0 & 0xe6) == 0xe6;
+    f.avx = ymm && (c & (1u << 28));
+    f.fma = f.avx && (c & (1u << 12));
+    f.f16c = f.avx && (c & (1u << 29));
+
+    if (__get_cpuid_max(0, nullptr) >= 7) {
+        __cpuid_count(7, 0, a, b, c, d);
+        f.avx2 = f.avx && (b & (1u << 5));
+        f.avx512f = zmm && (b & (1u << 16));
+        f.avx512dq = f.avx512f && (b & (1u << 17));
+        f.avx512bw = f.avx512f && (b & (1u << 30));
+        f.avx512vl = f.avx512f && (b & (1u << 31));
+        f.avx512vnni = f.avx512f && (c & (1u << 11));
+        __cpuid_count(7, 1, a, b, c, d);
+        f.avxvnni = f.avx2 && (a & (1u << 4));
+    }
+    return f;
+}
+#else
+static CpuFeatures detectFeatures() { return {}; }
+#endif
+
+const CpuFeatures &getCpuFeatures() {
+    static const CpuFeatures features = detectFeatures();
+    return features;
+}
+
+static CpuIsa detectIsa() {
+    auto &f = getCpuFeatures();
+    CpuIsa isa = CpuIsa::Scalar;
+    if (f.sse41 && f.sse42)
+        isa = CpuIsa::SSE4;
+    if (isa == CpuIsa::SSE4 && f.avx2 && f.fma)
+        isa = CpuIsa::AVX2;
+    if (isa == CpuIsa::AVX2 && f.avx512f && f.avx512bw && f.avx512dq &&
+        f.avx512vl)
+        isa = CpuIsa::AVX512;
+    if (auto env = std::getenv("INFINI_CPU_ISA")) {
+        auto cap = isaFromString(env);
+        IT_ASSERT(cap.has_value(),
+                  string("Unknown INFINI_CPU_ISA value: ") + env);
+        isa = std::min(isa, *cap);
+    }
+    return isa;
+}
+
+CpuIsa detectCpuIsa() {
+    static const CpuIsa isa = detectIsa();
+    return isa;
+}
+
+const char *isaToString(CpuIsa isa) {
+    switch (isa) {
+    case CpuIsa::Scalar:
+        return "scalar";
+    case CpuIsa::SSE4:
+        return "sse4";
+    case CpuIsa::AVX2:
+        return "avx2";
+    case CpuIsa::AVX512:
+        return "avx512";
+    default:
+        IT_TODO_HALT();
+    }
+}
+
+optional<CpuIsa> isaFromString(const string &name) {
+    for (auto isa :
+         {CpuIsa::Scalar, CpuIsa::SSE4, CpuIsa::AVX2, CpuIsa::AVX512})
+        if (name == isaToString(isa))
+            return isa;
+    return std::nullopt;
+}
+
+void pinCurrentThread(const vector<int> &cpus) {
+    IT_ASSERT(!cpus.empty());
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+        IT_ASSERT(cpu >= 0 && cpu < CPU_SETSIZE);
+        CPU_SET(cpu, &set);
+    }
+    // pid 0 is the calling thread
+    IT_ASSERT(sched_setaffinity(0, sizeof(set), &set) == 0,
+              string("sched_setaffinity: ") + std::strerror(errno) +
+                  ", cpus " + vecToString(cpus));
+#endif
+}
+
+static vector<int> detectAvailableCpus() {
+    vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.emplace_back(cpu);
+        return cpus;
+    }
+#endif
+    int n = std::max(1u, std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < n; ++cpu)
+        cpus.emplace_back(cpu);
+    return cpus;
+}
+
+const vector<int> &getAvailableCpus() {
+    // Read once: threads pinned later must not shrink the answer
+    static const vector<int> cpus = detectAvailableCpus();
+    return cpus;
+}
+
+static bool distinctCpus(vector<int> cpus) {
+    std::sort(cpus.begin(), cpus.end());
+    return std::adjacent_find(cpus.begin(), cpus.end()) == cpus.end();
+}
+
+CpuPartition CpuPartition::exclusive(vector<int> cpus) {
+    IT_ASSERT(!cpus.empty());
+    IT_ASSERT(distinctCpus(cpus), "CpuPartition lists a CPU twice");
+    return {std::move(cpus), Policy::Exclusive, 0};
+}
+
+CpuPartition CpuPartition::shared(vector<int> cpus, int maxThreads) {
+    IT_ASSERT(!cpus.empty() && maxThreads >= 0);
+    IT_ASSERT(distinctCpus(cpus), "CpuPartition lists a CPU twice");
+    return {std::move(cpus), Policy::Shared, maxThreads};
+}
+
+CpuPartition CpuPartition::all() {
+    auto partition = shared(getAvailableCpus());
+    partition.claimed = false;
+    return partition;
+}
+
+int CpuPartition::getNumThreads() const {
+    // More threads than CPUs oversubscribe them, e.g. to exercise the
+    // parallel paths on a small host
+    if (policy == Policy::Shared && maxThreads > 0)
+        return maxThreads;
+    return cpus.size();
+}
+
+vector<int> CpuPartition::getThreadCpus(int i) const {
+    IT_ASSERT(i >= 0 && i < getNumThreads());
+    if (policy == Policy::Exclusive)
+        return {cpus[i]};
+    return cpus;
+}
+
+string CpuPartition::toString() const {
+    return string(policy == Policy::Exclusive ? "exclusive" : "shared") +
+           " cpus " + vecToString(cpus) + ", " +
+           std::to_string(getNumThreads()) + " threads";
+}
+
+} // namespace infini
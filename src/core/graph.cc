@@ -1,4 +1,5 @@
 #include "core/graph.h"
+#include "core/metrics.h"
 #include <algorithm>
 #include <numeric>
 #include <queue>
@@ -416,6 +417,7 @@ namespace infini
         }
 
         allocator.info(); // 打印内存分配详情
+        Metrics::getInstance().recordBytesPlanned(allocator.getPeak());
     }
 
     /**
@@ -0,0 +1,58 @@
+#include "core/incremental.h"
+#include "core/blob.h"
+
+namespace infini {
+
+IncrementalExecutor::IncrementalExecutor(Graph graph) : graph(graph) {
+    plan = graph->getRuntime()->compile(graph);
+    IT_ASSERT(!plan->capturesBuffers(),
+              "Incremental execution needs one step per operator; disable "
+              "chain tiling for this runtime");
+
+    // A skipped step relies on its outputs not being overwritten by others
+    vector<pair<char *, size_t>> ranges;
+    for (auto &t : graph->getTensors()) {
+        IT_ASSERT(t->hasData(), "Tensor " + t->toString() + " has no data");
+        ranges.emplace_back(t->getRawDataPtr<char *>(), t->getBytes());
+    }
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); ++i)
+        IT_ASSERT(ranges[i - 1].first + ranges[i - 1].second <=
+                      ranges[i].first,
+                  "Tensors share memory; incremental execution needs a "
+                  "buffer per tensor");
+    seen.resize(plan->getSteps().size());
+}
+
+vector<uint64_t> IncrementalExecutor::versions(const Operator &op) const {
+    vector<uint64_t> v;
+    for (auto &t : op->getInputs())
+        v.emplace_back(t->getVersion());
+    for (auto &t : op->getOutputs())
+        v.emplace_back(t->getVersion());
+    return v;
+}
+
+size_t IncrementalExecutor::run() {
+    const auto &steps = plan->getSteps();
+    auto runtime = graph->getRuntime();
+    executed = 0;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        auto &op = steps[i].op;
+        if (!seen[i].empty() && seen[i] == versions(op))
+            continue;
+        runtime->executeSteps(plan, i, i + 1);
+        for (auto &t : op->getOutputs())
+            t->bumpVersion();
+        seen[i] = versions(op);
+        ++executed;
+    }
+    return executed;
+}
+
+void IncrementalExecutor::invalidate() {
+    for (auto &v : seen)
+        v.clear();
+}
+
+} // namespace infini
@@ -0,0 +1,199 @@
+#include "core/metrics.h"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+namespace infini {
+
+// Single writer per shard: a relaxed load-add-store is enough and cheaper
+// than a locked fetch_add.
+static inline void bump(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+Metrics::Shard &Metrics::local() {
+    thread_local Shard *shard = nullptr;
+    if (!shard) {
+        std::lock_guard<std::mutex> lock(mtx);
+        shard = shards.emplace_back(std::make_unique<Shard>()).get();
+    }
+    return *shard;
+}
+
+void Metrics::recordRun(uint64_t nanos) {
+    auto &s = local();
+    bump(s.runs, 1);
+    bump(s.runNanos, nanos);
+    size_t bucket = 0;
+    for (uint64_t us = nanos / 1000; us > 0 && bucket < s.runLatency.size() - 1;
+         us >>= 1)
+        ++bucket;
+    bump(s.runLatency[bucket], 1);
+}
+
+void Metrics::recordOp(OpType type, uint64_t nanos, bool fallback) {
+    auto &s = local();
+    size_t i = std::min<size_t>(type.underlying(), MaxOpTypes - 1);
+    bump(s.opCalls[i], 1);
+    bump(s.opNanos[i], nanos);
+    if (fallback)
+        bump(s.fallbackHits, 1);
+}
+
+void Metrics::recordBytesPlanned(uint64_t bytes) {
+    bump(local().bytesPlanned, bytes);
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    MetricsSnapshot snap;
+    std::array<MetricsSnapshot::OpStats, MaxOpTypes> ops{};
+    std::lock_guard<std::mutex> lock(mtx);
+    auto read = [](const std::atomic<uint64_t> &c) {
+        return c.load(std::memory_order_relaxed);
+    };
+    for (auto &s : shards) {
+        snap.runs += read(s->runs);
+        snap.runNanos += read(s->runNanos);
+        for (size_t i = 0; i < snap.runLatency.size(); ++i)
+            snap.runLatency[i] += read(s->runLatency[i]);
+        for (size_t i = 0; i < MaxOpTypes; ++i) {
+            ops[i].calls += read(s->opCalls[i]);
+            ops[i].nanos += read(s->opNanos[i]);
+        }
+        snap.bytesPlanned += read(s->bytesPlanned);
+        snap.fallbackHits += read(s->fallbackHits);
+    }
+    for (size_t i = 0; i < MaxOpTypes; ++i)
+        if (ops[i].calls)
+            snap.ops[OpType(OpType::underlying_t(i)).toString()] = ops[i];
+    return snap;
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto zero = [](std::atomic<uint64_t> &c) {
+        c.store(0, std::memory_order_relaxed);
+    };
+    for (auto &s : shards) {
+        zero(s->runs);
+        zero(s->runNanos);
+        for (auto &c : s->runLatency)
+            zero(c);
+        for (size_t i = 0; i < MaxOpTypes; ++i) {
+            zero(s->opCalls[i]);
+            zero(s->opNanos[i]);
+        }
+        zero(s->bytesPlanned);
+        zero(s->fallbackHits);
+    }
+}
+
+string MetricsSnapshot::toPrometheus() const {
+    std::ostringstream oss;
+    oss << std::setprecision(9);
+    auto header = [&](const char *name, const char *type, const char *help) {
+        oss << "# HELP " << name << " " << help << "\n# TYPE " << name << " "
+            << type << "\n";
+    };
+    header("infini_runs_total", "counter", "Graph runs executed.");
+    oss << "infini_runs_total " << runs << "\n";
+
+    header("infini_run_latency_seconds", "histogram",
+           "Wall-clock latency of graph runs.");
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < NumBuckets; ++i) {
+        cumulative += runLatency[i];
+        oss << "infini_run_latency_seconds_bucket{le=\"" << (1u << i) * 1e-6
+            << "\"} " << cumulative << "\n";
+    }
+    oss << "infini_run_latency_seconds_bucket{le=\"+Inf\"} " << runs << "\n"
+        << "infini_run_latency_seconds_sum " << runNanos * 1e-9 << "\n"
+        << "infini_run_latency_seconds_count " << runs << "\n";
+
+    header("infini_op_calls_total", "counter", "Operators executed by type.");
+    for (auto &[type, stats] : ops)
+        oss << "infini_op_calls_total{op=\"" << type << "\"} " << stats.calls
+            << "\n";
+    header("infini_op_seconds_total", "counter",
+           "Kernel time spent per operator type.");
+    for (auto &[type, stats] : ops)
+        oss << "infini_op_seconds_total{op=\"" << type << "\"} "
+            << stats.nanos * 1e-9 << "\n";
+
+    header("infini_bytes_planned_total", "counter",
+           "Bytes of tensor memory planned by allocators.");
+    oss << "infini_bytes_planned_total " << bytesPlanned << "\n";
+    header("infini_fallback_kernel_hits_total", "counter",
+           "Operators run by an untuned default kernel.");
+    oss << "infini_fallback_kernel_hits_total " << fallbackHits << "\n";
+    return oss.str();
+}
+
+string MetricsSnapshot::toJson() const {
+    std::ostringstream oss;
+    oss << "{\"runs\": " << runs << ", \"run_nanos\": " << runNanos
+        << ", \"run_latency_us_log2\": [";
+    for (size_t i = 0; i < runLatency.size(); ++i)
+        oss << (i ? ", " : "") << runLatency[i];
+    oss << "], \"ops\": {";
+    bool first = true;
+    for (auto &[type, stats] : ops) {
+        oss << (first ? "" : ", ") << "\"" << type << "\": {\"calls\": "
+            << stats.calls << ", \"nanos\": " << stats.nanos << "}";
+        first = false;
+    }
+    oss << "}, \"bytes_planned\": " << bytesPlanned
+        << ", \"fallback_hits\": " << fallbackHits << "}\n";
+    return oss.str();
+}
+
+MetricsExporter::MetricsExporter(string path, Format format,
+                                 std::chrono::milliseconds interval)
+    : path(std::move(path)), format(format), interval(interval) {
+    IT_ASSERT(interval.count() > 0);
+    worker = std::thread([this] { loop(); });
+}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+    writeOrReport();
+}
+
+void MetricsExporter::write() {
+    auto snap = Metrics::getInstance().snapshot();
+    auto tmp = path + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::trunc);
+        IT_ASSERT(ofs.good(), "Cannot write metrics file " + tmp);
+        ofs << (format == Format::Prometheus ? snap.toPrometheus()
+                                             : snap.toJson());
+    }
+    IT_ASSERT(std::rename(tmp.c_str(), path.c_str()) == 0,
+              "Cannot rename " + tmp + " to " + path);
+}
+
+void MetricsExporter::writeOrReport() noexcept {
+    try {
+        write();
+    } catch (const Exception &e) {
+        std::cerr << e.std::runtime_error::what() << std::endl;
+    }
+}
+
+void MetricsExporter::loop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!cv.wait_for(lock, interval, [this] { return stopping; })) {
+        lock.unlock();
+        // Keep exporting; the file system may recover
+        writeOrReport();
+        lock.lock();
+    }
+}
+
+} // namespace infini
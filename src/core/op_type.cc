@@ -21,6 +21,8 @@ namespace infini
             CASE(Transpose);
             CASE(Concat);
             CASE(MatMul);
+            CASE(QuantizedMatMul);
+            CASE(SparseMatMul);
 
         default:
             return "Unknown";
@@ -71,6 +71,16 @@ namespace infini
 
     optional<vector<Shape>> OperatorObj::inferShape() { return inferShape(inputs); }
 
+    uint64_t OperatorObj::getBytesMoved() const
+    {
+        uint64_t bytes = 0;
+        for (auto &input : inputs)
+            bytes += input->getBytes();
+        for (auto &output : outputs)
+            bytes += output->getBytes();
+        return bytes;
+    }
+
     vector<DataType> OperatorObj::inferDataType(const TensorVec &inputs) const
     {
         auto dataType = inputs[0]->getDType();
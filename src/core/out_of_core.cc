@@ -0,0 +1,307 @@
+#include "core/out_of_core.h"
+#include "core/blob.h"
+#include "core/kernel.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+namespace infini {
+
+/**
+ * @brief Anonymous scratch file served by one I/O thread. Requests run in
+ * submission order, so a read queued after a write of the same range sees
+ * the written data.
+ */
+class SpillFile {
+    int fd = -1;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::packaged_task<void()>> jobs;
+    bool stopping = false;
+    std::thread worker;
+
+  public:
+    explicit SpillFile(const string &dir) {
+        string path = dir + "/infini_spill_XXXXXX";
+        fd = mkstemp(path.data());
+        IT_ASSERT(fd >= 0, "Cannot create scratch file in " + dir + ": " +
+                               std::strerror(errno));
+        unlink(path.c_str()); // Reclaimed by the OS when closed
+        worker = std::thread([this] { loop(); });
+    }
+
+    ~SpillFile() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        worker.join();
+        close(fd);
+    }
+
+    std::shared_future<void> write(const void *data, size_t bytes,
+                                   size_t offset) {
+        return submit([=] {
+            auto p = static_cast<const char *>(data);
+            for (size_t done = 0; done < bytes;) {
+                auto n = pwrite(fd, p + done, bytes - done, offset + done);
+                IT_ASSERT(n > 0 || errno == EINTR,
+                          string("Spill write failed: ") + std::strerror(errno));
+                done += std::max<ssize_t>(n, 0);
+            }
+        });
+    }
+
+    std::shared_future<void> read(void *data, size_t bytes, size_t offset) {
+        return submit([=] {
+            auto p = static_cast<char *>(data);
+            for (size_t done = 0; done < bytes;) {
+                auto n = pread(fd, p + done, bytes - done, offset + done);
+                IT_ASSERT(n > 0 || (n < 0 && errno == EINTR),
+                          string("Spill read failed: ") +
+                              (n == 0 ? "unexpected end of file"
+                                      : std::strerror(errno)));
+                done += std::max<ssize_t>(n, 0);
+            }
+        });
+    }
+
+  private:
+    std::shared_future<void> submit(std::function<void()> fn) {
+        std::packaged_task<void()> task(std::move(fn));
+        auto fut = task.get_future().share();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            jobs.emplace_back(std::move(task));
+        }
+        cv.notify_one();
+        return fut;
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+            auto task = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            task(); // Exceptions land in the task's future
+            lock.lock();
+        }
+    }
+};
+
+OutOfCoreExecutor::OutOfCoreExecutor(Graph graph, size_t memoryBudget,
+                                     const string &scratchDir)
+    : graph(graph), memoryBudget(memoryBudget) {
+    plan = graph->getRuntime()->compile(graph);
+    IT_ASSERT(!plan->capturesBuffers(),
+              "Out-of-core execution rebinds buffers; disable chain tiling "
+              "for this runtime");
+    const auto &steps = plan->getSteps();
+
+    std::unordered_map<TensorObj *, size_t> index;
+    for (size_t i = 0; i < steps.size(); ++i)
+        for (auto &t : steps[i].op->getOutputs())
+            if (!t->getTargets().empty()) {
+                index[t.get()] = intermediates.size();
+                intermediates.push_back({t, i, {}});
+            }
+    for (size_t i = 0; i < steps.size(); ++i)
+        for (auto &t : steps[i].op->getInputs())
+            if (auto it = index.find(t.get()); it != index.end()) {
+                auto &consumers = intermediates[it->second].consumers;
+                if (consumers.empty() || consumers.back() != i)
+                    consumers.emplace_back(i);
+            }
+
+    // Inputs and outputs stay resident for the executor's lifetime
+    auto runtime = graph->getRuntime();
+    for (auto &t : graph->getTensors()) {
+        if (index.count(t.get()))
+            continue;
+        pinnedBytes += t->getBytes();
+        if (t->hasData())
+            continue;
+        pinned.emplace_back(runtime->alloc(t->getBytes()));
+        t->setDataBlob(make_ref<BlobObj>(runtime, pinned.back()));
+    }
+
+    planSpills();
+    size_t fileBytes = 0;
+    for (auto &info : intermediates)
+        if (info.spilled) {
+            info.fileOffset = fileBytes;
+            fileBytes += info.tensor->getBytes();
+        }
+    if (fileBytes)
+        file = std::make_unique<SpillFile>(scratchDir);
+}
+
+OutOfCoreExecutor::~OutOfCoreExecutor() {
+    file.reset();
+    for (auto ptr : pinned)
+        graph->getRuntime()->dealloc(ptr);
+}
+
+vector<pair<size_t, size_t>>
+OutOfCoreExecutor::residency(const TensorInfo &info) const {
+    if (!info.spilled)
+        return {{info.producer, info.consumers.back()}};
+    // Produced and written back, then prefetched one step ahead of every
+    // consumer; overlapping intervals are merged
+    vector<pair<size_t, size_t>> intervals{{info.producer, info.producer + 1}};
+    for (auto c : info.consumers) {
+        if (c - 1 <= intervals.back().second)
+            intervals.back().second = std::max(intervals.back().second, c);
+        else
+            intervals.emplace_back(c - 1, c);
+    }
+    return intervals;
+}
+
+void OutOfCoreExecutor::planSpills() {
+    size_t nSteps = plan->getSteps().size();
+    while (true) {
+        vector<size_t> bytes(nSteps, pinnedBytes);
+        for (auto &info : intermediates)
+            for (auto [b, e] : residency(info))
+                for (size_t i = b; i <= e && i < nSteps; ++i)
+                    bytes[i] += info.tensor->getBytes();
+        size_t worst =
+            std::max_element(bytes.begin(), bytes.end()) - bytes.begin();
+        plannedPeak = nSteps ? bytes[worst] : pinnedBytes;
+        if (plannedPeak <= memoryBudget)
+            break;
+
+        // Spill the candidate needed furthest in the future, as long as
+        // spilling actually frees it at the worst step
+        TensorInfo *best = nullptr;
+        size_t bestNext = 0;
+        for (auto &info : intermediates) {
+            if (info.spilled || info.producer > worst ||
+                info.consumers.back() < worst)
+                continue;
+            info.spilled = true;
+            bool frees = true;
+            for (auto [b, e] : residency(info))
+                frees &= worst < b || worst > e;
+            info.spilled = false;
+            if (!frees)
+                continue;
+            size_t next = *std::upper_bound(info.consumers.begin(),
+                                            info.consumers.end(), worst);
+            if (!best || next > bestNext ||
+                (next == bestNext &&
+                 info.tensor->getBytes() > best->tensor->getBytes())) {
+                best = &info;
+                bestNext = next;
+            }
+        }
+        IT_ASSERT(best, "Memory budget of " + std::to_string(memoryBudget) +
+                            " bytes is too small: step " +
+                            std::to_string(worst) + " needs " +
+                            std::to_string(bytes[worst]));
+        best->spilled = true;
+    }
+
+    enter.assign(nSteps, {});
+    leave.assign(nSteps, {});
+    for (size_t i = 0; i < intermediates.size(); ++i)
+        for (auto [b, e] : residency(intermediates[i])) {
+            enter[b].emplace_back(i);
+            leave[std::min(e, nSteps - 1)].emplace_back(i);
+        }
+}
+
+void OutOfCoreExecutor::acquire(TensorInfo &info) {
+    auto runtime = graph->getRuntime();
+    auto bytes = info.tensor->getBytes();
+    info.buffer = runtime->alloc(bytes);
+    info.tensor->setDataBlob(make_ref<BlobObj>(runtime, info.buffer));
+    current += bytes;
+    peak = std::max(peak, current);
+}
+
+void OutOfCoreExecutor::release(TensorInfo &info) {
+    if (info.io.valid()) {
+        info.io.get(); // The buffer is in use until its I/O is done
+        info.io = {};
+    }
+    graph->getRuntime()->dealloc(info.buffer);
+    info.buffer = nullptr;
+    info.tensor->setDataBlob(nullptr);
+    current -= info.tensor->getBytes();
+}
+
+void OutOfCoreExecutor::run() {
+    const auto &steps = plan->getSteps();
+    current = peak = pinnedBytes;
+    std::unordered_map<TensorObj *, TensorInfo *> byTensor;
+    for (auto &info : intermediates)
+        byTensor[info.tensor.get()] = &info;
+
+    try {
+        for (size_t i = 0; i < steps.size(); ++i) {
+            for (auto idx : enter[i]) {
+                auto &info = intermediates[idx];
+                acquire(info);
+                if (i != info.producer) {
+                    info.io = file->read(info.buffer, info.tensor->getBytes(),
+                                         info.fileOffset);
+                    info.reading = true;
+                }
+            }
+            for (auto &t : steps[i].op->getInputs()) {
+                auto it = byTensor.find(t.get());
+                if (it != byTensor.end() && it->second->reading) {
+                    it->second->io.get();
+                    it->second->io = {};
+                    it->second->reading = false;
+                }
+            }
+            graph->getRuntime()->executeSteps(plan, i, i + 1);
+            for (auto &t : steps[i].op->getOutputs()) {
+                auto it = byTensor.find(t.get());
+                if (it != byTensor.end() && it->second->spilled)
+                    it->second->io =
+                        file->write(it->second->buffer, t->getBytes(),
+                                    it->second->fileOffset);
+            }
+            for (auto idx : leave[i])
+                release(intermediates[idx]);
+        }
+    } catch (...) {
+        for (auto &info : intermediates) {
+            if (!info.buffer)
+                continue;
+            try {
+                release(info);
+            } catch (...) {
+                // Keep the first error
+            }
+            info.reading = false;
+        }
+        throw;
+    }
+}
+
+TensorVec OutOfCoreExecutor::getSpilled() const {
+    TensorVec spilled;
+    for (auto &info : intermediates)
+        if (info.spilled)
+            spilled.emplace_back(info.tensor);
+    return spilled;
+}
+
+} // namespace infini
@@ -0,0 +1,216 @@
+#include "core/pipeline_executor.h"
+#include "core/blob.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+PipelineExecutor::PipelineExecutor(Graph graph, TensorVec microBatchInputs,
+                                   int numStages, int depth,
+                                   vector<vector<int>> stageCpus)
+    : graph(graph) {
+    IT_ASSERT(depth >= 1);
+    IT_ASSERT(stageCpus.empty() || (int)stageCpus.size() == numStages,
+              "Need one CPU group per stage");
+    plan = graph->getRuntime()->compile(graph);
+    IT_ASSERT(!plan->capturesBuffers(),
+              "Pipelines rebind operators to per-slot buffers; disable "
+              "chain tiling for this runtime");
+    IT_ASSERT(numStages >= 1 && numStages <= (int)plan->getSteps().size());
+    splitStages(numStages);
+
+    slots.resize(depth);
+    for (auto &slot : slots)
+        buildSlot(slot, microBatchInputs);
+    for (int i = 0; i <= numStages; ++i)
+        queues.emplace_back(std::make_unique<SpscQueue<int>>(depth + 1));
+    for (int i = 0; i < depth; ++i)
+        queues.back()->push(i);
+
+    // Threads report whether pinning succeeded before they start looping
+    vector<std::future<void>> pinned;
+    for (size_t s = 0; s < stages.size(); ++s) {
+        if (!stageCpus.empty())
+            stages[s].cpus = stageCpus[s];
+        auto ready = std::make_shared<std::promise<void>>();
+        pinned.emplace_back(ready->get_future());
+        stages[s].thread = std::thread([this, s, ready] {
+            try {
+                if (!stages[s].cpus.empty())
+                    pinCurrentThread(stages[s].cpus);
+                ready->set_value();
+            } catch (...) {
+                ready->set_exception(std::current_exception());
+            }
+            loop(s);
+        });
+    }
+    try {
+        for (auto &f : pinned)
+            f.get();
+    } catch (...) {
+        stop();
+        for (auto &slot : slots)
+            graph->getRuntime()->dealloc(slot.buffer);
+        throw;
+    }
+}
+
+PipelineExecutor::~PipelineExecutor() {
+    stop();
+    for (auto &slot : slots)
+        graph->getRuntime()->dealloc(slot.buffer);
+}
+
+void PipelineExecutor::stop() {
+    std::lock_guard<std::mutex> lock(submitMtx);
+    if (stopped)
+        return;
+    stopped = true;
+    // The sentinel follows every pending micro-batch through all stages
+    queues[0]->pushWait(-1);
+    for (auto &stage : stages)
+        stage.thread.join();
+}
+
+void PipelineExecutor::splitStages(size_t numStages) {
+    auto &steps = plan->getSteps();
+    vector<double> cost;
+    double total = 0;
+    for (auto &step : steps) {
+        // Every operator costs at least one unit so empty ones still spread
+        cost.emplace_back(1.0 + step.op->getFlops() +
+                          step.op->getBytesMoved());
+        total += cost.back();
+    }
+    double acc = 0;
+    size_t begin = 0;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        acc += cost[i];
+        size_t remainingSteps = steps.size() - i - 1;
+        size_t remainingStages = numStages - stages.size() - 1;
+        // Close the stage at its share of the total cost, but leave at least
+        // one operator for every later stage
+        bool full = acc >= total * (stages.size() + 1) / numStages;
+        if (remainingStages > 0 &&
+            (full || remainingSteps == remainingStages)) {
+            stages.push_back({begin, i + 1, {}, {}});
+            begin = i + 1;
+        }
+    }
+    stages.push_back({begin, steps.size(), {}, {}});
+    IT_ASSERT(stages.size() == numStages);
+}
+
+void PipelineExecutor::buildSlot(Slot &slot,
+                                 const TensorVec &microBatchInputs) {
+    auto runtime = graph->getRuntime();
+    std::unordered_set<TensorObj *> perBatch;
+    for (auto &t : microBatchInputs)
+        perBatch.insert(t.get());
+
+    // Graph tensor -> tensor of this slot. Shared inputs map to themselves,
+    // everything else gets a 64-byte aligned range of the slot buffer.
+    std::unordered_map<TensorObj *, Tensor> mapped;
+    vector<pair<Tensor, size_t>> owned;
+    size_t bytes = 0;
+    for (auto &t : graph->getTensors()) {
+        if (!t->getSource() && !perBatch.count(t.get())) {
+            IT_ASSERT(t->hasData(), "Shared input " + t->toString() +
+                                        " has no data");
+            mapped[t.get()] = t;
+            continue;
+        }
+        auto clone = make_ref<TensorObj>(t->getDims(), t->getDType(), runtime);
+        mapped[t.get()] = clone;
+        owned.emplace_back(clone, bytes);
+        bytes += (t->getBytes() + 63) / 64 * 64;
+    }
+    slot.buffer = runtime->alloc(bytes);
+    for (auto &[t, offset] : owned)
+        t->setDataBlob(
+            make_ref<BlobObj>(runtime, (char *)slot.buffer + offset));
+
+    for (auto &step : plan->getSteps()) {
+        TensorVec inputs, outputs;
+        for (auto &t : step.op->getInputs())
+            inputs.emplace_back(mapped.at(t.get()));
+        for (auto &t : step.op->getOutputs())
+            outputs.emplace_back(mapped.at(t.get()));
+        slot.ops.emplace_back(step.op->clone(inputs, outputs));
+    }
+    for (auto &t : microBatchInputs)
+        slot.inputs.emplace_back(mapped.at(t.get()));
+    for (auto &t : graph->getOutputs())
+        slot.outputs.emplace_back(mapped.at(t.get()));
+}
+
+std::future<PipelineExecutor::Sample>
+PipelineExecutor::submit(const Sample &inputs) {
+    IT_ASSERT(inputs.size() == slots[0].inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+        IT_ASSERT(inputs[i].size() == slots[0].inputs[i]->getBytes(),
+                  "Input " + std::to_string(i) + " has " +
+                      std::to_string(inputs[i].size()) + " bytes, expected " +
+                      std::to_string(slots[0].inputs[i]->getBytes()));
+
+    std::lock_guard<std::mutex> lock(submitMtx);
+    IT_ASSERT(!stopped);
+    int id = queues.back()->popWait();
+    auto &slot = slots[id];
+    for (size_t i = 0; i < inputs.size(); ++i)
+        std::memcpy(slot.inputs[i]->getRawDataPtr<void *>(), inputs[i].data(),
+                    inputs[i].size());
+    slot.result = std::promise<Sample>();
+    slot.error = nullptr;
+    auto fut = slot.result.get_future();
+    queues[0]->pushWait(id);
+    return fut;
+}
+
+void PipelineExecutor::loop(size_t s) {
+    auto &stage = stages[s];
+    auto &steps = plan->getSteps();
+    auto context = graph->getRuntime().get();
+    bool last = s + 1 == stages.size();
+    while (true) {
+        int id = queues[s]->popWait();
+        if (id < 0) {
+            if (!last)
+                queues[s + 1]->pushWait(id);
+            return;
+        }
+        auto &slot = slots[id];
+        if (!slot.error) {
+            try {
+                for (size_t i = stage.begin; i < stage.end; ++i)
+                    steps[i].kernel->compute(slot.ops[i], context);
+            } catch (...) {
+                slot.error = std::current_exception();
+            }
+        }
+        if (!last) {
+            queues[s + 1]->pushWait(id);
+            continue;
+        }
+        if (slot.error) {
+            slot.result.set_exception(slot.error);
+        } else {
+            Sample result;
+            for (auto &t : slot.outputs) {
+                auto src = t->getRawDataPtr<uint8_t *>();
+                result.emplace_back(src, src + t->getBytes());
+            }
+            slot.result.set_value(std::move(result));
+        }
+        queues[s + 1]->pushWait(id); // Back to submit()
+    }
+}
+
+vector<pair<size_t, size_t>> PipelineExecutor::getStageBounds() const {
+    vector<pair<size_t, size_t>> bounds;
+    for (auto &stage : stages)
+        bounds.emplace_back(stage.begin, stage.end);
+    return bounds;
+}
+
+} // namespace infini
@@ -0,0 +1,15 @@
+#include "core/plan.h"
+
+namespace infini {
+
+string PlanObj::toString() const {
+    std::ostringstream oss;
+    oss << "Plan of " << steps.size() << " steps, isa " << isaToString(isa)
+        << ":\n";
+    for (size_t i = 0; i < steps.size(); ++i)
+        oss << "  " << i << ": " << steps[i].kernelName << ", "
+            << steps[i].op << "\n";
+    return oss.str();
+}
+
+} // namespace infini
@@ -0,0 +1,94 @@
+#include "core/plan_cache.h"
+#include "core/blob.h"
+#include "core/metrics.h"
+
+namespace infini {
+
+PlanCache::PlanCache(Graph graph, TensorVec dynamicInputs)
+    : graph(graph), dynamicInputs(std::move(dynamicInputs)) {
+    IT_ASSERT(this->graph->topo_sort() == true);
+    auto inputs = this->graph->getInputs();
+    for (auto &t : this->dynamicInputs)
+        IT_ASSERT(std::find(inputs.begin(), inputs.end(), t) != inputs.end(),
+                  "Dynamic input " + t->toString() + " is not a graph input");
+}
+
+Plan PlanCache::activate(const vector<Shape> &inputShapes) {
+    IT_ASSERT(inputShapes.size() == dynamicInputs.size());
+    auto it = entries.find(inputShapes);
+    if (it == entries.end())
+        it = entries.emplace(inputShapes, build(inputShapes)).first;
+    if (active != &it->second) {
+        bind(it->second);
+        active = &it->second;
+    }
+    return it->second.plan;
+}
+
+size_t PlanCache::getActiveBytes() const {
+    return active ? active->arenaBytes : 0;
+}
+
+PlanCache::Entry PlanCache::build(const vector<Shape> &inputShapes) {
+    for (size_t i = 0; i < dynamicInputs.size(); ++i)
+        dynamicInputs[i]->setShape(inputShapes[i]);
+    graph->shape_infer();
+
+    Entry entry;
+    auto runtime = graph->getRuntime();
+    entry.arena = std::make_unique<Allocator>(runtime);
+    const auto &tensors = graph->getTensors();
+    const auto &ops = graph->getOperators();
+
+    // Last step reading each tensor; graph outputs and dynamic inputs live
+    // for the whole run
+    std::unordered_map<TensorObj *, size_t> lastUse;
+    for (size_t i = 0; i < ops.size(); ++i)
+        for (auto &t : ops[i]->getInputs())
+            lastUse[t.get()] = i;
+    for (auto &t : graph->getOutputs())
+        lastUse[t.get()] = ops.size();
+
+    std::unordered_map<TensorObj *, size_t> offsets;
+    for (auto &t : dynamicInputs)
+        offsets[t.get()] = entry.arena->alloc(t->getBytes());
+    for (size_t i = 0; i < ops.size(); ++i) {
+        for (auto &t : ops[i]->getOutputs())
+            offsets[t.get()] = entry.arena->alloc(t->getBytes());
+        // Inputs whose last reader this is can be reused from now on. An
+        // operator may read the same tensor twice; free it once.
+        std::unordered_set<TensorObj *> freed;
+        for (auto &t : ops[i]->getInputs())
+            if (t->getSource() && lastUse.at(t.get()) == i &&
+                freed.insert(t.get()).second)
+                entry.arena->free(offsets.at(t.get()), t->getBytes());
+    }
+    for (auto &t : tensors)
+        IT_ASSERT(t->getSource() || offsets.count(t.get()) || t->hasData(),
+                  "Static input " + t->toString() + " has no data");
+
+    auto base = static_cast<char *>(entry.arena->getPtr());
+    for (auto &t : tensors) {
+        auto it = offsets.find(t.get());
+        if (it != offsets.end())
+            t->setDataBlob(make_ref<BlobObj>(runtime, base + it->second));
+        entry.shapes.emplace_back(t->getDims());
+        entry.blobs.emplace_back(t->getDataBlob());
+    }
+    entry.arenaBytes = entry.arena->getPeak();
+    Metrics::getInstance().recordBytesPlanned(entry.arenaBytes);
+    // Kernels are selected for this signature's shapes
+    entry.plan = runtime->compile(graph);
+    active = nullptr;
+    return entry;
+}
+
+void PlanCache::bind(const Entry &entry) {
+    const auto &tensors = graph->getTensors();
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        tensors[i]->setShape(entry.shapes[i]);
+        tensors[i]->setDataBlob(entry.blobs[i]);
+    }
+}
+
+} // namespace infini
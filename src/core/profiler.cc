@@ -0,0 +1,283 @@
+#include "core/profiler.h"
+#include "utils/isa_dispatch.h"
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace infini {
+
+#ifdef __linux__
+static int openEvent(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+Profiler::Profiler(bool useCounters) : wantCounters(useCounters) {
+    if (!wantCounters)
+        unavailableReason = "disabled";
+}
+
+Profiler::~Profiler() { closeCounters(); }
+
+void Profiler::openCounters() {
+    closeCounters();
+    owner = std::this_thread::get_id();
+    if (!wantCounters)
+        return;
+#ifdef __linux__
+    const std::pair<uint32_t, uint64_t> events[] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}, // LLC on x86
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+    for (auto &[type, config] : events) {
+        int fd = openEvent(type, config, fds.empty() ? -1 : fds[0]);
+        if (fd < 0) {
+            unavailableReason = std::strerror(errno);
+            closeCounters();
+            return;
+        }
+        fds.emplace_back(fd);
+    }
+    counters = true;
+#else
+    unavailableReason = "perf_event_open is Linux only";
+#endif
+}
+
+void Profiler::closeCounters() {
+#ifdef __linux__
+    for (auto fd : fds)
+        close(fd);
+#endif
+    fds.clear();
+    counters = false;
+}
+
+bool Profiler::hasCounters() {
+    if (owner != std::this_thread::get_id())
+        openCounters();
+    return counters;
+}
+
+void Profiler::begin() {
+    if (owner != std::this_thread::get_id())
+        openCounters();
+#ifdef __linux__
+    if (counters) {
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+    beg = std::chrono::steady_clock::now();
+}
+
+void Profiler::end(const Operator &op, const string &kernelName) {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t values[1 + 4] = {0};
+#ifdef __linux__
+    if (counters) {
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (read(fds[0], values, sizeof(values)) != sizeof(values))
+            std::memset(values, 0, sizeof(values));
+    }
+#endif
+    auto [it, inserted] = index.try_emplace(op->getGuid(), records.size());
+    if (inserted) {
+        records.emplace_back();
+        records.back().guid = op->getGuid();
+        records.back().type = op->getOpType();
+        records.back().kernelName = kernelName;
+    }
+    auto &r = records[it->second];
+    r.calls++;
+    r.seconds += std::chrono::duration<double>(now - beg).count();
+    r.cycles += values[1];
+    r.instructions += values[2];
+    r.llcMisses += values[3];
+    r.branchMisses += values[4];
+    r.flops += op->getFlops();
+    r.bytes += op->getBytesMoved();
+}
+
+// Peak loops: independent multiply-add chains kept in registers, enough of
+// them to cover the FMA latency. Each returns a value depending on every
+// chain so nothing is optimized away.
+static float peakLoopScalar(size_t iters) {
+    float acc[8];
+    for (int i = 0; i < 8; ++i)
+        acc[i] = i * 1e-3f;
+    for (size_t it = 0; it < iters; ++it) {
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i)
+            acc[i] = acc[i] * 0.9999f + 1e-4f;
+    }
+    float sum = 0;
+    for (int i = 0; i < 8; ++i)
+        sum += acc[i];
+    return sum;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+IT_TARGET_SSE4 static float peakLoopSse4(size_t iters) {
+    __m128 acc[12];
+    for (int i = 0; i < 12; ++i)
+        acc[i] = _mm_set1_ps(i * 1e-3f);
+    const __m128 m = _mm_set1_ps(0.9999f), c = _mm_set1_ps(1e-4f);
+    for (size_t it = 0; it < iters; ++it) {
+#pragma GCC unroll 12
+        for (int i = 0; i < 12; ++i)
+            acc[i] = _mm_add_ps(_mm_mul_ps(acc[i], m), c);
+    }
+    for (int i = 1; i < 12; ++i)
+        acc[0] = _mm_add_ps(acc[0], acc[i]);
+    return _mm_cvtss_f32(acc[0]);
+}
+
+IT_TARGET_AVX2 static float peakLoopAvx2(size_t iters) {
+    __m256 acc[12];
+    for (int i = 0; i < 12; ++i)
+        acc[i] = _mm256_set1_ps(i * 1e-3f);
+    const __m256 m = _mm256_set1_ps(0.9999f), c = _mm256_set1_ps(1e-4f);
+    for (size_t it = 0; it < iters; ++it) {
+#pragma GCC unroll 12
+        for (int i = 0; i < 12; ++i)
+            acc[i] = _mm256_fmadd_ps(acc[i], m, c);
+    }
+    for (int i = 1; i < 12; ++i)
+        acc[0] = _mm256_add_ps(acc[0], acc[i]);
+    return _mm256_cvtss_f32(acc[0]);
+}
+
+IT_TARGET_AVX512 static float peakLoopAvx512(size_t iters) {
+    __m512 acc[16];
+    for (int i = 0; i < 16; ++i)
+        acc[i] = _mm512_set1_ps(i * 1e-3f);
+    const __m512 m = _mm512_set1_ps(0.9999f), c = _mm512_set1_ps(1e-4f);
+    for (size_t it = 0; it < iters; ++it) {
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; ++i)
+            acc[i] = _mm512_fmadd_ps(acc[i], m, c);
+    }
+    for (int i = 1; i < 16; ++i)
+        acc[0] = _mm512_add_ps(acc[0], acc[i]);
+    return _mm512_cvtss_f32(acc[0]);
+}
+
+static const IsaDispatch<float (*)(size_t)> peakLoop{
+    peakLoopScalar, peakLoopSse4, peakLoopAvx2, peakLoopAvx512};
+// FLOPs of one iteration of each loop above
+static const double peakLoopFlops[] = {8 * 2, 12 * 4 * 2, 12 * 8 * 2,
+                                       16 * 16 * 2};
+#else
+static const IsaDispatch<float (*)(size_t)> peakLoop{peakLoopScalar, nullptr,
+                                                      nullptr, nullptr};
+static const double peakLoopFlops[] = {8 * 2, 8 * 2, 8 * 2, 8 * 2};
+#endif
+
+MachinePeaks Profiler::calibrate(CpuIsa isa) {
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::time_point beg) {
+        return std::chrono::duration<double>(clock::now() - beg).count();
+    };
+    MachinePeaks peaks;
+
+    auto loop = peakLoop.get(isa);
+    int level = static_cast<int>(isa);
+    const size_t iters = 1 << 22;
+    volatile float sink = 0;
+    double best = 0;
+    for (int rep = 0; rep < 3; ++rep) {
+        auto beg = clock::now();
+        sink = sink + loop(iters);
+        double t = seconds(beg);
+        best = rep == 0 ? t : std::min(best, t);
+    }
+    peaks.gflops = peakLoopFlops[level] * iters / best / 1e9;
+
+    // Triad a = b + s * c over 3 x 32 MiB, counting 12 bytes per element
+    const size_t n = size_t(8) << 20;
+    vector<float> a(n, 0.f), b(n, 1.f), c(n, 2.f);
+    best = 0;
+    for (int rep = 0; rep < 3; ++rep) {
+        auto beg = clock::now();
+        for (size_t i = 0; i < n; ++i)
+            a[i] = b[i] + 0.5f * c[i];
+        double t = seconds(beg);
+        best = rep == 0 ? t : std::min(best, t);
+    }
+    sink = sink + a[n / 2];
+    peaks.gbps = 3.0 * sizeof(float) * n / best / 1e9;
+    return peaks;
+}
+
+void Profiler::reset() {
+    records.clear();
+    index.clear();
+}
+
+string Profiler::report() const {
+    std::ostringstream oss;
+    oss << std::fixed;
+    if (!counters)
+        oss << "Hardware counters unavailable (" << unavailableReason
+            << "), wall-clock only\n";
+    if (peaks)
+        oss << "Machine peaks: " << std::setprecision(1) << peaks->gflops
+            << " GFLOP/s, " << peaks->gbps << " GB/s\n";
+    oss << std::left << std::setw(8) << "Op" << std::setw(12) << "Type"
+        << std::setw(24) << "Kernel" << std::right << std::setw(8) << "Calls"
+        << std::setw(12) << "Time(ms)" << std::setw(10) << "GFLOP/s"
+        << std::setw(10) << "GB/s" << std::setw(10) << "FLOP/B";
+    if (peaks)
+        oss << std::setw(8) << "%Roof";
+    if (counters)
+        oss << std::setw(8) << "IPC" << std::setw(14) << "LLC miss/call"
+            << std::setw(14) << "Br miss/call";
+    oss << "\n";
+    double total = 0;
+    for (auto &r : records) {
+        total += r.seconds;
+        oss << std::left << std::setw(8) << r.guid << std::setw(12)
+            << r.type.toString() << std::setw(24) << r.kernelName
+            << std::right << std::setw(8) << r.calls << std::setw(12)
+            << std::setprecision(3) << r.seconds * 1e3 << std::setw(10)
+            << std::setprecision(2) << r.gflops() << std::setw(10)
+            << r.gbps() << std::setw(10) << r.intensity();
+        if (peaks) {
+            // Attainable performance under the roofline at this intensity
+            double roof = std::min(peaks->gflops, r.intensity() * peaks->gbps);
+            double achieved = r.flops ? r.gflops() / roof : r.gbps() / peaks->gbps;
+            oss << std::setw(8) << std::setprecision(1) << achieved * 100;
+        }
+        if (counters)
+            oss << std::setw(8) << std::setprecision(2) << r.ipc()
+                << std::setw(14) << std::setprecision(0)
+                << double(r.llcMisses) / r.calls << std::setw(14)
+                << double(r.branchMisses) / r.calls;
+        oss << "\n";
+    }
+    oss << "Total: " << std::setprecision(3) << total * 1e3 << " ms\n";
+    return oss.str();
+}
+
+} // namespace infini
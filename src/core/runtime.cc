@@ -1,27 +1,286 @@
 #include "core/runtime.h"
 #include "core/blob.h"
-#include "core/kernel.h"
 #include "core/graph.h"
 #include "core/kernel.h"
+#include "core/metrics.h"
+#include "core/plan.h"
+#include "core/profiler.h"
+#include "core/tiling.h"
+#include "core/tuner.h"
 #include <chrono>
 #include <cstring>
 #include <memory>
+#include <mutex>
 namespace infini
 {
+    // CPUs claimed by live runtimes: exclusive ones, and use counts of shared
+    // ones. Unclaimed partitions, i.e. all(), are not counted; their runtimes
+    // are listed instead, to move their workers off exclusive CPUs.
+    static std::mutex claimMtx;
+    static std::set<int> exclusiveCpus;
+    static std::map<int, int> sharedCpus;
+    static std::set<const NativeCpuRuntimeObj *> yieldingRuntimes;
+
+    // The CPUs of an unclaimed partition no runtime holds exclusively, or all
+    // of them if every one is held. Called with claimMtx held.
+    static vector<int> unclaimedCpus(const CpuPartition &partition)
+    {
+        vector<int> cpus;
+        for (auto cpu : partition.cpus)
+            if (!exclusiveCpus.count(cpu))
+                cpus.emplace_back(cpu);
+        return cpus.empty() ? partition.cpus : cpus;
+    }
+
+    // Called with claimMtx held whenever the exclusive CPUs change
+    static void repinYieldingRuntimes()
+    {
+        for (auto runtime : yieldingRuntimes)
+            runtime->getThreadPool().pinWorkers(
+                unclaimedCpus(runtime->getPartition()));
+    }
+
+    static void claimCpus(const CpuPartition &partition)
+    {
+        if (!partition.claimed)
+            return;
+        std::lock_guard<std::mutex> lock(claimMtx);
+        bool exclusive =
+            partition.policy == CpuPartition::Policy::Exclusive;
+        for (auto cpu : partition.cpus)
+        {
+            IT_ASSERT(!exclusiveCpus.count(cpu) &&
+                          !(exclusive && sharedCpus.count(cpu)),
+                      "CPU " + std::to_string(cpu) +
+                          " is already used by another runtime");
+        }
+        for (auto cpu : partition.cpus)
+        {
+            if (exclusive)
+                exclusiveCpus.insert(cpu);
+            else
+                sharedCpus[cpu]++;
+        }
+        if (exclusive)
+            repinYieldingRuntimes();
+    }
+
+    static void releaseCpus(const CpuPartition &partition)
+    {
+        if (!partition.claimed)
+            return;
+        std::lock_guard<std::mutex> lock(claimMtx);
+        for (auto cpu : partition.cpus)
+        {
+            if (partition.policy == CpuPartition::Policy::Exclusive)
+                exclusiveCpus.erase(cpu);
+            else if (--sharedCpus[cpu] == 0)
+                sharedCpus.erase(cpu);
+        }
+        if (partition.policy == CpuPartition::Policy::Exclusive)
+            repinYieldingRuntimes();
+    }
+
+    NativeCpuRuntimeObj::NativeCpuRuntimeObj(CpuPartition partition,
+                                             WaitPolicy waitPolicy)
+        : RuntimeObj(Device::CPU), isa(detectCpuIsa()),
+          partition(std::move(partition))
+    {
+        auto available = getAvailableCpus();
+        for (auto cpu : this->partition.cpus)
+        {
+            IT_ASSERT(std::binary_search(available.begin(), available.end(),
+                                         cpu),
+                      "CPU " + std::to_string(cpu) +
+                          " is not available to this process");
+        }
+        claimCpus(this->partition);
+        try
+        {
+            vector<vector<int>> workerCpus;
+            for (int i = 1; i < this->partition.getNumThreads(); ++i)
+                workerCpus.emplace_back(this->partition.getThreadCpus(i));
+            pool = std::make_unique<ThreadPool>(
+                this->partition.getNumThreads(), workerCpus, waitPolicy);
+        }
+        catch (...)
+        {
+            releaseCpus(this->partition);
+            throw;
+        }
+        if (!this->partition.claimed)
+        {
+            std::lock_guard<std::mutex> lock(claimMtx);
+            yieldingRuntimes.insert(this);
+            pool->pinWorkers(unclaimedCpus(this->partition));
+        }
+    }
+
+    NativeCpuRuntimeObj::~NativeCpuRuntimeObj()
+    {
+        if (!partition.claimed)
+        {
+            std::lock_guard<std::mutex> lock(claimMtx);
+            yieldingRuntimes.erase(this);
+        }
+        pool.reset();
+        releaseCpus(partition);
+    }
+
+    void RuntimeObj::checkKernels(const Graph &graph) const
+    {
+        const auto &kernelRegistry = KernelRegistry::sealed();
+        string missing;
+        for (auto &op : graph->getOperators())
+        {
+            auto opType = op->getOpType().underlying();
+            if (kernelRegistry.findKernels(device, opType, op->getDType()))
+                continue;
+            missing += "\n  " + op->toString() + ": no kernel for {" +
+                       get_kernel_attrs_str({device, opType, op->getDType()}) +
+                       "}";
+        }
+        IT_ASSERT(missing.empty(), "Graph has operators without kernels:" +
+                                       missing);
+    }
+
+    void NativeCpuRuntimeObj::bindCurrentThread() const
+    {
+        if (partition.claimed)
+        {
+            pinCurrentThread(partition.getThreadCpus(0));
+            return;
+        }
+        std::lock_guard<std::mutex> lock(claimMtx);
+        pinCurrentThread(unclaimedCpus(partition));
+    }
+
+    // What a tiled plan depends on: the operators, the tensor buffers, the
+    // tile size and the ISA level
+    static vector<const void *> planSignature(const Graph &graph,
+                                              size_t tileBytes, CpuIsa isa)
+    {
+        vector<const void *> signature{graph.get(), (const void *)tileBytes,
+                                       (const void *)(size_t)isa};
+        for (auto &op : graph->getOperators())
+            signature.emplace_back(op.get());
+        for (auto &t : graph->getTensors())
+            signature.emplace_back(t->hasData() ? t->getRawDataPtr<void *>()
+                                                : nullptr);
+        return signature;
+    }
+
     void NativeCpuRuntimeObj::run(const Graph &graph) const
     {
-        const auto &kernelRegistry = KernelRegistry::getInstance();
+        if (!tileBytes)
+        {
+            execute(compile(graph));
+            return;
+        }
+        Plan plan;
+        {
+            std::lock_guard<std::mutex> lock(tiledMtx);
+            IT_ASSERT(graph->topo_sort() == true);
+            auto signature = planSignature(graph, tileBytes, isa);
+            if (!tiledPlan || signature != tiledSignature)
+            {
+                tiledPlan = compile(graph);
+                tiledSignature = std::move(signature);
+            }
+            plan = tiledPlan;
+        }
+        execute(plan);
+    }
+
+    void NativeCpuRuntimeObj::setTileBytes(size_t bytes)
+    {
+        tileBytes = bytes;
+        std::lock_guard<std::mutex> lock(tiledMtx);
+        tiledPlan = nullptr;
+        tiledSignature.clear();
+    }
 
+    Plan NativeCpuRuntimeObj::compile(const Graph &graph) const
+    {
+        IT_ASSERT(graph->topo_sort() == true);
+        checkKernels(graph);
+        const auto &kernelRegistry = KernelRegistry::sealed();
+        auto &tuner = KernelTuner::getInstance();
+
+        vector<PlanObj::Step> steps;
         for (auto &op : graph->getOperators())
         {
-            auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-            Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
-            kernel->compute(op, this);
+            const auto &candidates = *kernelRegistry.findKernels(
+                device, op->getOpType().underlying(), op->getDType());
+            const auto &record = candidates.size() == 1
+                                     ? candidates.front()
+                                     : tuner.select(op, candidates, this);
+            // A tuned choice is cached; without one the default was taken
+            bool fallback = candidates.size() > 1 &&
+                            !tuner.lookup(KernelTuner::getKey(op, this));
+            steps.push_back(
+                {op, std::get<0>(record), std::get<1>(record), fallback});
+        }
+        auto plan = make_ref<PlanObj>(graph, std::move(steps), isa);
+        return tileBytes ? tileChains(plan, tileBytes) : plan;
+    }
+
+    void NativeCpuRuntimeObj::execute(const Plan &plan) const
+    {
+        auto &metrics = Metrics::getInstance();
+        if (!metrics.isEnabled())
+        {
+            executeSteps(plan, 0, plan->getSteps().size());
+            return;
+        }
+        auto beg = std::chrono::steady_clock::now();
+        executeSteps(plan, 0, plan->getSteps().size());
+        metrics.recordRun(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - beg)
+                              .count());
+    }
+
+    void NativeCpuRuntimeObj::executeSteps(const Plan &plan, size_t begin,
+                                           size_t end) const
+    {
+        IT_ASSERT(plan->getIsa() == isa,
+                  "Plan was compiled for a different ISA level");
+        const auto &steps = plan->getSteps();
+        IT_ASSERT(begin <= end && end <= steps.size());
+        auto &metrics = Metrics::getInstance();
+        bool timed = metrics.isEnabled();
+        if (!profiler && !timed)
+        {
+            for (size_t i = begin; i < end; ++i)
+                steps[i].kernel->compute(steps[i].op, this);
+            return;
+        }
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto &step = steps[i];
+            if (profiler)
+                profiler->begin();
+            auto beg = std::chrono::steady_clock::now();
+            step.kernel->compute(step.op, this);
+            auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - beg)
+                             .count();
+            if (profiler)
+                profiler->end(step.op, step.kernelName);
+            if (timed)
+                metrics.recordOp(step.op->getOpType(), nanos, step.fallback);
         }
     }
 
     string NativeCpuRuntimeObj::toString() const { return "CPU Runtime"; }
 
+    void NativeCpuRuntimeObj::setIsa(CpuIsa isa)
+    {
+        IT_ASSERT(isa <= detectCpuIsa(),
+                  string("Host does not support ") + isaToString(isa));
+        this->isa = isa;
+    }
+
     void NativeCpuRuntimeObj::dealloc(void *ptr)
     {
         return free(ptr);
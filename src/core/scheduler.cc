@@ -0,0 +1,131 @@
+#include "core/scheduler.h"
+
+namespace infini {
+
+GraphScheduler::GraphScheduler(Runtime runtime) : runtime(runtime) {
+    worker = std::thread([this] { loop(); });
+}
+
+GraphScheduler::~GraphScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+std::future<void>
+GraphScheduler::submit(const Graph &graph, int priority,
+                       optional<Clock::time_point> deadline) {
+    return submit(runtime->compile(graph), priority, deadline);
+}
+
+std::future<void>
+GraphScheduler::submit(const Plan &plan, int priority,
+                       optional<Clock::time_point> deadline) {
+    IT_ASSERT(plan->getGraph()->getRuntime() == runtime,
+              "Plan belongs to another runtime");
+    auto req = std::make_unique<Request>();
+    req->plan = plan;
+    req->priority = priority;
+    req->deadline = deadline;
+    auto fut = req->done.get_future();
+    if (plan->getSteps().empty()) {
+        req->done.set_value();
+        return fut;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        IT_ASSERT(!stopping);
+        req->seq = nextSeq++;
+        requests.emplace_back(std::move(req));
+    }
+    cv.notify_one();
+    return fut;
+}
+
+GraphScheduler::Stats GraphScheduler::getStats() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return stats;
+}
+
+GraphScheduler::Request *GraphScheduler::pick() {
+    Request *best = nullptr;
+    auto urgent = [](const Request *a, const Request *b) {
+        if (a->priority != b->priority)
+            return a->priority > b->priority;
+        if (a->deadline != b->deadline) {
+            if (!a->deadline || !b->deadline)
+                return bool(a->deadline);
+            return *a->deadline < *b->deadline;
+        }
+        return a->seq < b->seq;
+    };
+    for (auto &req : requests) {
+        // Only the oldest request of each graph may run
+        bool blocked = std::any_of(
+            requests.begin(), requests.end(), [&](const auto &other) {
+                return other->seq < req->seq &&
+                       other->plan->getGraph() == req->plan->getGraph();
+            });
+        if (!blocked && (!best || urgent(req.get(), best)))
+            best = req.get();
+    }
+    return best;
+}
+
+void GraphScheduler::finish(Request *req, std::exception_ptr error) {
+    if (error)
+        req->done.set_exception(error);
+    else
+        req->done.set_value();
+    requests.erase(std::find_if(requests.begin(), requests.end(),
+                                [&](const auto &r) { return r.get() == req; }));
+}
+
+void GraphScheduler::loop() {
+    Request *last = nullptr;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        cv.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (requests.empty())
+            return; // stopping and drained
+        auto req = pick();
+        auto now = Clock::now();
+        if (req->next == 0 && req->deadline && *req->deadline < now) {
+            stats.dropped++;
+            finish(req, std::make_exception_ptr(
+                            Exception("Deadline passed before the request "
+                                      "started")));
+            continue;
+        }
+        if (last && last != req && last->next > 0)
+            stats.preemptions++;
+        last = req;
+
+        // The request stays in `requests` while its operator runs, and only
+        // this thread advances or removes it.
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            runtime->executeSteps(req->plan, req->next, req->next + 1);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        req->next++;
+        stats.opsExecuted++;
+        if (error || req->next == req->plan->getSteps().size()) {
+            if (!error) {
+                stats.completed++;
+                if (req->deadline && *req->deadline < Clock::now())
+                    stats.deadlineMisses++;
+            }
+            finish(req, error);
+            last = nullptr;
+        }
+    }
+}
+
+} // namespace infini
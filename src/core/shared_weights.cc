@@ -0,0 +1,158 @@
+#include "core/shared_weights.h"
+#include "core/blob.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace infini {
+
+namespace {
+
+constexpr uint64_t Magic = 0x5754485349464e49; // "INFISHTW"
+constexpr size_t MaxRank = 8;
+
+// Segment layout: Header, one Entry per tensor, then the data of every
+// tensor at a 64-byte aligned offset.
+struct Header {
+    uint64_t magic;
+    std::atomic<uint32_t> ready; // Set once all data is in place
+    uint32_t count;
+    uint64_t bytes;
+};
+
+struct Entry {
+    int32_t dtype;
+    uint32_t rank;
+    uint64_t offset;
+    uint64_t bytes;
+    int64_t dims[MaxRank];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "The ready flag is shared between processes");
+
+size_t align64(size_t n) { return (n + 63) / 64 * 64; }
+
+Entry *entries(void *base) {
+    return reinterpret_cast<Entry *>(static_cast<char *>(base) +
+                                     sizeof(Header));
+}
+
+string errorText(const string &what, const string &name) {
+    return what + " " + name + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+SharedWeights::~SharedWeights() { munmap(base, bytes); }
+
+Ref<SharedWeights> SharedWeights::publish(const string &name,
+                                          const TensorVec &tensors) {
+    size_t total = align64(sizeof(Header) + tensors.size() * sizeof(Entry));
+    vector<Entry> table;
+    for (auto &t : tensors) {
+        IT_ASSERT(t->hasData(), "Tensor " + t->toString() + " has no data");
+        IT_ASSERT(t->getRank() <= MaxRank);
+        Entry e{t->getDType().getIndex(), (uint32_t)t->getRank(), total,
+                t->getBytes(), {}};
+        auto dims = t->getDims();
+        std::copy(dims.begin(), dims.end(), e.dims);
+        table.emplace_back(e);
+        total += align64(t->getBytes());
+    }
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    IT_ASSERT(fd >= 0, errorText("Cannot create shared memory", name));
+    void *base = MAP_FAILED;
+    if (ftruncate(fd, total) == 0)
+        base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        errno = err;
+        IT_ASSERT(false, errorText("Cannot map shared memory", name));
+    }
+    Ref<SharedWeights> segment(new SharedWeights(name, base, total));
+
+    auto header = new (base) Header{Magic, {0}, (uint32_t)tensors.size(),
+                                    total};
+    std::copy(table.begin(), table.end(), entries(base));
+    for (size_t i = 0; i < tensors.size(); ++i)
+        std::memcpy(static_cast<char *>(base) + table[i].offset,
+                    tensors[i]->getRawDataPtr<void *>(), table[i].bytes);
+    header->ready.store(1, std::memory_order_release);
+    // The publisher reads the weights like everyone else
+    if (mprotect(base, total, PROT_READ) != 0) {
+        int err = errno;
+        shm_unlink(name.c_str());
+        errno = err;
+        IT_ASSERT(false, errorText("Cannot protect shared memory", name));
+    }
+    bind(segment, tensors);
+    return segment;
+}
+
+Ref<SharedWeights> SharedWeights::attach(const string &name,
+                                         const TensorVec &tensors) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    IT_ASSERT(fd >= 0, errorText("Cannot open shared memory", name));
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(Header))
+        base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    IT_ASSERT(base != MAP_FAILED,
+              "Cannot map shared memory " + name + ": not a weight segment");
+    Ref<SharedWeights> segment(new SharedWeights(name, base, st.st_size));
+
+    auto header = static_cast<const Header *>(base);
+    IT_ASSERT(header->magic == Magic && header->bytes == (size_t)st.st_size,
+              name + " is not a weight segment");
+    IT_ASSERT(header->ready.load(std::memory_order_acquire),
+              name + " is still being published");
+    IT_ASSERT(header->count == tensors.size(),
+              name + " holds " + std::to_string(header->count) +
+                  " tensors, expected " + std::to_string(tensors.size()));
+    // Everything the table points at lies inside the mapping, even for a
+    // truncated or foreign segment
+    size_t size = st.st_size;
+    IT_ASSERT(sizeof(Header) + header->count * sizeof(Entry) <= size,
+              name + " is truncated");
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        auto &e = entries(base)[i];
+        auto &t = tensors[i];
+        IT_ASSERT(e.offset <= size && e.bytes <= size - e.offset,
+                  "Tensor " + std::to_string(i) + " of " + name +
+                      " lies outside the segment");
+        Shape dims(e.dims, e.dims + std::min<size_t>(e.rank, MaxRank));
+        IT_ASSERT(e.dtype == t->getDType().getIndex() && dims == t->getDims() &&
+                      e.bytes == t->getBytes(),
+                  "Tensor " + std::to_string(i) + " of " + name +
+                      " does not match " + t->toString());
+    }
+    bind(segment, tensors);
+    return segment;
+}
+
+void SharedWeights::remove(const string &name) {
+    IT_ASSERT(shm_unlink(name.c_str()) == 0,
+              errorText("Cannot remove shared memory", name));
+}
+
+void SharedWeights::bind(const Ref<SharedWeights> &segment,
+                         const TensorVec &tensors) {
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        auto ptr = static_cast<char *>(segment->base) +
+                   entries(segment->base)[i].offset;
+        tensors[i]->setDataBlob(
+            make_ref<BlobObj>(tensors[i]->getRuntime(), ptr, segment));
+    }
+}
+
+} // namespace infini
@@ -109,8 +109,12 @@ void TensorObj::setData(
     const std::function<void(void *, size_t, DataType)> &generator) const {
     IT_ASSERT(data != nullptr);
     generator(getRawDataPtr<void *>(), size(), dtype);
+    ++version;
 }
 
-void TensorObj::setDataBlob(const Blob &blob) { this->data = blob; }
+void TensorObj::setDataBlob(const Blob &blob) {
+    this->data = blob;
+    ++version;
+}
 
 }; // namespace infini
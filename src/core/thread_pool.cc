@@ -0,0 +1,201 @@
+#include "core/thread_pool.h"
+#include "core/cpu_info.h"
+#include "core/runtime.h"
+#include <future>
+#include <utility>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace infini {
+
+namespace {
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+constexpr int ChunkBits = 16;
+
+} // namespace
+
+ThreadPool::ThreadPool(int numThreads, const vector<vector<int>> &workerCpus,
+                       WaitPolicy policy)
+    : policy(policy),
+      oversubscribed((size_t)numThreads > getAvailableCpus().size()) {
+    IT_ASSERT(numThreads >= 1 && numThreads < (1 << ChunkBits));
+    IT_ASSERT(workerCpus.empty() || (int)workerCpus.size() == numThreads - 1,
+              "Need one CPU group per worker");
+    // Pin before the workers become visible, so a bad CPU set fails here
+    for (int i = 0; i < numThreads - 1; ++i) {
+        auto ready = std::make_shared<std::promise<void>>();
+        auto pinned = ready->get_future();
+        vector<int> cpus = workerCpus.empty() ? vector<int>{} : workerCpus[i];
+        workers.emplace_back([this, i, cpus, ready] {
+            try {
+                if (!cpus.empty())
+                    pinCurrentThread(cpus);
+                ready->set_value();
+            } catch (...) {
+                ready->set_exception(std::current_exception());
+            }
+            loop(i);
+        });
+        try {
+            pinned.get();
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() { shutdown(); }
+
+void ThreadPool::pinWorkers(const vector<int> &cpus) noexcept {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus)
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    for (auto &w : workers)
+        pthread_setaffinity_np(w.native_handle(), sizeof(set), &set);
+#endif
+}
+
+void ThreadPool::shutdown() {
+    stopping = true;
+    notify(wake, parkedWorkers);
+    for (auto &w : workers)
+        w.join();
+    workers.clear();
+}
+
+template <typename Pred>
+void ThreadPool::await(Pred ready, std::condition_variable &cv,
+                       std::atomic<int> &parked) {
+    using Clock = std::chrono::steady_clock;
+    auto relax = oversubscribed ? [] { std::this_thread::yield(); } : cpuRelax;
+    if (policy.mode == WaitPolicy::Mode::Hot) {
+        while (!ready())
+            relax();
+        return;
+    }
+    if (ready())
+        return;
+    if (policy.spin.count() > 0 || policy.yield.count() > 0) {
+        auto start = Clock::now();
+        auto spinEnd = start + policy.spin;
+        auto yieldEnd = spinEnd + policy.yield;
+        // Reading the clock on every iteration would slow the spin down
+        for (unsigned i = 1;; ++i) {
+            if (ready())
+                return;
+            if (i % 64 == 0 && Clock::now() >= spinEnd)
+                break;
+            relax();
+        }
+        while (Clock::now() < yieldEnd) {
+            if (ready())
+                return;
+            std::this_thread::yield();
+        }
+    }
+    std::unique_lock<std::mutex> lock(mtx);
+    ++parked;
+    cv.wait(lock, ready);
+    --parked;
+}
+
+void ThreadPool::notify(std::condition_variable &cv,
+                        std::atomic<int> &parked) {
+    // The state change is stored before `parked` is read and a waiter raises
+    // `parked` before checking the state, so one of the two sees the other.
+    // Taking the mutex makes sure a waiter seen here is already waiting.
+    if (parked == 0)
+        return;
+    { std::lock_guard<std::mutex> lock(mtx); }
+    cv.notify_all();
+}
+
+void ThreadPool::runChunk(size_t chunk) {
+    size_t begin = jobSize * chunk / jobChunks;
+    size_t end = jobSize * (chunk + 1) / jobChunks;
+    try {
+        (*job)(begin, end);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!error)
+            error = std::current_exception();
+    }
+}
+
+void ThreadPool::parallelFor(size_t n,
+                             const std::function<void(size_t, size_t)> &fn,
+                             size_t grain) {
+    if (n == 0)
+        return;
+    size_t chunks = std::min<size_t>(getNumThreads(),
+                                     (n + grain - 1) / std::max<size_t>(grain, 1));
+    std::unique_lock<std::mutex> busy(dispatchMtx, std::try_to_lock);
+    if (chunks <= 1 || !busy.owns_lock()) {
+        fn(0, n);
+        return;
+    }
+    // No worker touches the job fields between jobs
+    job = &fn;
+    jobSize = n;
+    jobChunks = chunks;
+    error = nullptr;
+    pending = chunks - 1;
+    ticket = ((ticket >> ChunkBits) + 1) << ChunkBits | chunks;
+    notify(wake, parkedWorkers);
+    runChunk(0);
+    await([this] { return pending == 0; }, done, parkedCaller);
+    job = nullptr;
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+void ThreadPool::loop(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        await([&] { return stopping || ticket != seen; }, wake,
+              parkedWorkers);
+        if (stopping)
+            return;
+        seen = ticket;
+        // Worker i takes chunk i + 1; chunk 0 belongs to the caller. A worker
+        // without a chunk may see the ticket late, after the caller moved
+        // on, so it decides from the ticket alone.
+        size_t chunks = seen & ((1 << ChunkBits) - 1);
+        if (worker + 1 >= chunks)
+            continue;
+        runChunk(worker + 1);
+        if (--pending == 0)
+            notify(done, parkedCaller);
+    }
+}
+
+void parallelFor(const RuntimeObj *context, size_t n,
+                 const std::function<void(size_t, size_t)> &fn,
+                 size_t grain) {
+    if (auto cpu = dynamic_cast<const NativeCpuRuntimeObj *>(context))
+        cpu->getThreadPool().parallelFor(n, fn, grain);
+    else
+        fn(0, n);
+}
+
+int getParallelism(const RuntimeObj *context) {
+    if (auto cpu = dynamic_cast<const NativeCpuRuntimeObj *>(context))
+        return cpu->getThreadPool().getNumThreads();
+    return 1;
+}
+
+} // namespace infini
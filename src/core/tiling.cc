@@ -0,0 +1,242 @@
+#include "core/tiling.h"
+#include "core/blob.h"
+#include <algorithm>
+#include <numeric>
+
+namespace infini {
+
+namespace {
+
+bool isTileable(OpType type) {
+    switch (type.underlying()) {
+    case OpType::Add:
+    case OpType::Sub:
+    case OpType::Mul:
+    case OpType::Div:
+    case OpType::Relu:
+    case OpType::Clip:
+        return true;
+    default:
+        return false;
+    }
+}
+
+size_t product(const Shape &shape, size_t begin, size_t end) {
+    return std::accumulate(shape.begin() + begin, shape.begin() + end,
+                           size_t(1), std::multiplies<size_t>());
+}
+
+// Layout of the tiles of one chain output shape: every tile is `len` (or
+// fewer, for the last) consecutive indices of axis `axis`, for one index of
+// the axes before it, and is therefore contiguous in memory.
+struct TileLayout {
+    Shape shape;
+    size_t axis;
+    size_t inner; // Elements per index of `axis`
+    size_t len;
+
+    TileLayout(const Shape &shape, size_t elemSize, size_t tileBytes)
+        : shape(shape) {
+        axis = 0;
+        while (axis + 1 < shape.size() &&
+               product(shape, axis + 1, shape.size()) * elemSize > tileBytes)
+            ++axis;
+        inner = product(shape, axis + 1, shape.size());
+        len = std::clamp<size_t>(tileBytes / (inner * elemSize), 1,
+                                 shape[axis]);
+    }
+
+    size_t numTiles() const {
+        return product(shape, 0, axis) *
+               ((shape[axis] + len - 1) / len);
+    }
+
+    // Dimensions a tile keeps: `axis` and the ones after it
+    size_t tileRank() const { return shape.size() - axis; }
+
+    // An operand of another shape can be read whole by every tile if it is
+    // broadcast along all tiled axes; returns its shape within a tile.
+    optional<Shape> broadcastShape(const Shape &dims) const {
+        size_t rank = tileRank();
+        for (size_t i = 0; i + rank < dims.size(); ++i)
+            if (dims[i] != 1)
+                return std::nullopt;
+        Shape trimmed(dims.end() - std::min(dims.size(), rank), dims.end());
+        // The tiled axis itself must be broadcast too, unless the tile
+        // covers all of it
+        if (trimmed.size() == rank && trimmed[0] != 1 &&
+            !(trimmed[0] == shape[axis] && len == (size_t)shape[axis]))
+            return std::nullopt;
+        return trimmed;
+    }
+};
+
+class TiledChainKernel : public Kernel {
+    Runtime runtime;
+    void *scratch = nullptr;
+    // Per tile, the chain's operators cloned onto that tile
+    vector<vector<pair<Kernel *, Operator>>> tiles;
+
+  public:
+    TiledChainKernel(Runtime runtime, size_t scratchBytes)
+        : runtime(runtime) {
+        if (scratchBytes)
+            scratch = runtime->alloc(scratchBytes);
+    }
+    ~TiledChainKernel() {
+        if (scratch)
+            runtime->dealloc(scratch);
+    }
+
+    void *getScratch() const { return scratch; }
+    void addTile(vector<pair<Kernel *, Operator>> tile) {
+        tiles.emplace_back(std::move(tile));
+    }
+
+    void compute(const Operator &, const RuntimeObj *context) const override {
+        for (auto &tile : tiles)
+            for (auto &[kernel, op] : tile)
+                kernel->compute(op, context);
+    }
+};
+
+// Whether `op` may join a chain tiled by `layout`, given the tensors
+// produced by the chain so far.
+bool canJoin(const Operator &op, const TileLayout &layout, DataType dtype,
+             const std::unordered_set<TensorObj *> &produced) {
+    if (!isTileable(op->getOpType()) || op->getOutputs().size() != 1)
+        return false;
+    auto output = op->getOutput();
+    if (output->getDims() != layout.shape || !(output->getDType() == dtype) ||
+        !output->hasData())
+        return false;
+    bool consumesChain = produced.empty();
+    for (auto &t : op->getInputs()) {
+        if (produced.count(t.get())) {
+            consumesChain = true;
+            continue;
+        }
+        if (!t->hasData() || !(t->getDType() == dtype))
+            return false;
+        if (t->getDims() != layout.shape &&
+            !layout.broadcastShape(t->getDims()))
+            return false;
+    }
+    return consumesChain;
+}
+
+} // namespace
+
+Plan tileChains(const Plan &plan, size_t tileBytes) {
+    IT_ASSERT(tileBytes > 0);
+    const auto &steps = plan->getSteps();
+    auto runtime = plan->getGraph()->getRuntime();
+    vector<PlanObj::Step> tiled;
+    vector<std::shared_ptr<Kernel>> owned;
+
+    size_t i = 0;
+    while (i < steps.size()) {
+        auto first = steps[i].op;
+        auto dtype = first->getOutputs()[0]->getDType();
+        TileLayout layout(first->getOutputs()[0]->getDims(), dtype.getSize(),
+                          tileBytes);
+        std::unordered_set<TensorObj *> produced;
+        size_t end = i;
+        while (end < steps.size() &&
+               canJoin(steps[end].op, layout, dtype, produced)) {
+            produced.insert(steps[end].op->getOutput().get());
+            ++end;
+        }
+        if (end - i < 2 || layout.numTiles() < 2) {
+            tiled.emplace_back(steps[i]);
+            ++i;
+            continue;
+        }
+
+        // Intermediates read only inside the chain live in scratch memory
+        std::unordered_set<OperatorObj *> members;
+        for (size_t j = i; j < end; ++j)
+            members.insert(steps[j].op.get());
+        size_t tileBytesAligned =
+            (layout.len * layout.inner * dtype.getSize() + 63) / 64 * 64;
+        std::unordered_map<TensorObj *, size_t> scratchOffset;
+        for (size_t j = i; j < end; ++j) {
+            auto out = steps[j].op->getOutput();
+            auto targets = out->getTargets();
+            bool internal =
+                !targets.empty() &&
+                std::all_of(targets.begin(), targets.end(), [&](auto &op) {
+                    return members.count(op.get());
+                });
+            if (internal)
+                scratchOffset.emplace(out.get(), scratchOffset.size() *
+                                                     tileBytesAligned);
+        }
+        auto kernel = std::make_shared<TiledChainKernel>(
+            runtime, scratchOffset.size() * tileBytesAligned);
+        auto scratch = static_cast<char *>(kernel->getScratch());
+
+        // Broadcast operands are shared by all tiles
+        std::unordered_map<TensorObj *, Tensor> whole;
+        auto outer = product(layout.shape, 0, layout.axis);
+        auto extent = (size_t)layout.shape[layout.axis];
+        for (size_t o = 0; o < outer; ++o)
+            for (size_t start = 0; start < extent; start += layout.len) {
+                size_t len = std::min(layout.len, extent - start);
+                Shape tileShape(layout.shape.begin() + layout.axis,
+                                layout.shape.end());
+                tileShape[0] = len;
+                size_t elemOffset = (o * extent + start) * layout.inner;
+
+                std::unordered_map<TensorObj *, Tensor> mapped;
+                auto view = [&](const Tensor &t) -> Tensor {
+                    if (auto it = mapped.find(t.get()); it != mapped.end())
+                        return it->second;
+                    Tensor v;
+                    if (auto it = scratchOffset.find(t.get());
+                        it != scratchOffset.end()) {
+                        v = make_ref<TensorObj>(tileShape, dtype, runtime);
+                        v->setDataBlob(
+                            make_ref<BlobObj>(runtime, scratch + it->second));
+                    } else if (t->getDims() == layout.shape) {
+                        v = make_ref<TensorObj>(tileShape, dtype, runtime);
+                        v->setDataBlob(make_ref<BlobObj>(
+                            runtime, t->getRawDataPtr<char *>() +
+                                         elemOffset * dtype.getSize()));
+                    } else if (auto w = whole.find(t.get()); w != whole.end()) {
+                        v = w->second;
+                    } else {
+                        v = make_ref<TensorObj>(*layout.broadcastShape(
+                                                    t->getDims()),
+                                                dtype, runtime);
+                        v->setDataBlob(t->getDataBlob());
+                        whole.emplace(t.get(), v);
+                    }
+                    return mapped[t.get()] = v;
+                };
+
+                vector<pair<Kernel *, Operator>> tile;
+                for (size_t j = i; j < end; ++j) {
+                    TensorVec inputs, outputs;
+                    for (auto &t : steps[j].op->getInputs())
+                        inputs.emplace_back(view(t));
+                    outputs.emplace_back(view(steps[j].op->getOutput()));
+                    tile.emplace_back(steps[j].kernel,
+                                      steps[j].op->clone(inputs, outputs));
+                }
+                kernel->addTile(std::move(tile));
+            }
+
+        tiled.push_back({steps[end - 1].op, kernel.get(),
+                         "TiledChain(" + std::to_string(end - i) + ")",
+                         false});
+        owned.emplace_back(kernel);
+        i = end;
+    }
+    if (owned.empty())
+        return plan;
+    return make_ref<PlanObj>(plan->getGraph(), std::move(tiled),
+                             plan->getIsa(), std::move(owned));
+}
+
+} // namespace infini
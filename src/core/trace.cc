@@ -0,0 +1,399 @@
+#include "core/trace.h"
+#include "core/blob.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/quantized_matmul.h"
+#include "operators/sparse_matmul.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include <chrono>
+#include <fstream>
+
+namespace infini {
+
+namespace {
+
+constexpr char Magic[8] = {'I', 'N', 'F', 'T', 'R', 'A', 'C', 'E'};
+// 2: op types stored by name, since their codes move as ops are added
+constexpr uint32_t Version = 2;
+
+int64_t floatBits(float f) {
+    int32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(int64_t bits) {
+    int32_t b = bits;
+    float f;
+    std::memcpy(&f, &b, sizeof(f));
+    return f;
+}
+
+// Attributes an operator is rebuilt from, besides its tensors
+vector<int64_t> encodeAttrs(const Operator &op) {
+    switch (op->getOpType().underlying()) {
+    case OpType::Add:
+    case OpType::Sub:
+    case OpType::Mul:
+    case OpType::Div:
+    case OpType::Relu:
+        return {};
+    case OpType::Clip: {
+        auto clip = as<ClipObj>(op);
+        auto min = clip->getMin(), max = clip->getMax();
+        return {min.has_value(), floatBits(min.value_or(0)), max.has_value(),
+                floatBits(max.value_or(0))};
+    }
+    case OpType::Cast:
+        return {(int64_t)as<CastObj>(op)->getType()};
+    case OpType::Concat:
+        return {as<ConcatObj>(op)->getDim()};
+    case OpType::Transpose: {
+        auto permute = as<TransposeObj>(op)->getPermute();
+        return vector<int64_t>(permute.begin(), permute.end());
+    }
+    case OpType::MatMul: {
+        auto matmul = as<MatmulObj>(op);
+        return {matmul->getTransA(), matmul->getTransB()};
+    }
+    case OpType::QuantizedMatMul: {
+        auto qmm = as<QuantizedMatmulObj>(op);
+        return {floatBits(qmm->getScaleA()), qmm->getZeroA(),
+                qmm->getOutputType().getIndex(), floatBits(qmm->getScaleC()),
+                qmm->getZeroC()};
+    }
+    case OpType::SparseMatMul:
+        return {(int64_t)as<SparseMatmulObj>(op)->getFormat()};
+    default:
+        IT_TODO_HALT_MSG(string("Cannot trace ") + op->getOpType().toString());
+    }
+}
+
+void addOp(Graph &g, OpType type, const vector<int64_t> &attrs,
+           const TensorVec &in, const TensorVec &out) {
+    auto attr = [&](size_t i) {
+        IT_ASSERT(i < attrs.size(), "Truncated operator attributes");
+        return attrs[i];
+    };
+    switch (type.underlying()) {
+    case OpType::Add:
+        g->addOpWithOutputs<AddObj>(in.at(0), in.at(1), out.at(0));
+        break;
+    case OpType::Sub:
+        g->addOpWithOutputs<SubObj>(in.at(0), in.at(1), out.at(0));
+        break;
+    case OpType::Mul:
+        g->addOpWithOutputs<MulObj>(in.at(0), in.at(1), out.at(0));
+        break;
+    case OpType::Div:
+        g->addOpWithOutputs<DivObj>(in.at(0), in.at(1), out.at(0));
+        break;
+    case OpType::Relu:
+        g->addOpWithOutputs<ReluObj>(in.at(0), out.at(0));
+        break;
+    case OpType::Clip: {
+        optional<float> min, max;
+        if (attr(0))
+            min = bitsFloat(attr(1));
+        if (attr(2))
+            max = bitsFloat(attr(3));
+        g->addOpWithOutputs<ClipObj>(in.at(0), out.at(0), min, max);
+        break;
+    }
+    case OpType::Cast:
+        g->addOpWithOutputs<CastObj>(in.at(0), out.at(0), (CastType)attr(0));
+        break;
+    case OpType::Concat:
+        g->addOpWithOutputs<ConcatObj>(in, out.at(0), (int)attr(0));
+        break;
+    case OpType::Transpose:
+        g->addOpWithOutputs<TransposeObj>(
+            in.at(0), out.at(0), vector<int>(attrs.begin(), attrs.end()));
+        break;
+    case OpType::MatMul:
+        g->addOpWithOutputs<MatmulObj>(in.at(0), in.at(1), out.at(0),
+                                       (bool)attr(0), (bool)attr(1));
+        break;
+    case OpType::QuantizedMatMul:
+        g->addOpWithOutputs<QuantizedMatmulObj>(
+            in.at(0), in.at(1), in.at(2), in.at(3), out.at(0),
+            bitsFloat(attr(0)), (int)attr(1), DataType((int)attr(2)),
+            bitsFloat(attr(3)), (int)attr(4));
+        break;
+    case OpType::SparseMatMul:
+        g->addOpWithOutputs<SparseMatmulObj>(in.at(0), in.at(1), in.at(2),
+                                             in.at(3), out.at(0),
+                                             (SparseFormat)attr(0));
+        break;
+    default:
+        IT_TODO_HALT_MSG(string("Cannot replay ") + type.toString());
+    }
+}
+
+// The inverse of OpType::toString(); the op types are numbered without gaps
+std::optional<OpType> opTypeByName(const string &name) {
+    for (OpType::underlying_t v = OpType::Unknown + 1;; ++v) {
+        OpType type(v);
+        string typeName = type.toString();
+        if (typeName == "Unknown")
+            return std::nullopt;
+        if (typeName == name)
+            return type;
+    }
+}
+
+class Writer {
+    std::ofstream out;
+
+  public:
+    explicit Writer(const string &path) : out(path, std::ios::binary) {
+        IT_ASSERT(out.good(), "Cannot write " + path);
+    }
+    template <typename T> void pod(const T &v) {
+        out.write(reinterpret_cast<const char *>(&v), sizeof(T));
+    }
+    template <typename T> void array(const vector<T> &v) {
+        pod<uint64_t>(v.size());
+        out.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+    }
+    void str(const string &s) { array(vector<char>(s.begin(), s.end())); }
+    bool good() const { return out.good(); }
+};
+
+class Reader {
+    std::ifstream in;
+    string path;
+
+  public:
+    explicit Reader(const string &path) : in(path, std::ios::binary), path(path) {
+        IT_ASSERT(in.good(), "Cannot read " + path);
+    }
+    template <typename T> T pod() {
+        T v;
+        in.read(reinterpret_cast<char *>(&v), sizeof(T));
+        IT_ASSERT(in.good(), path + " is truncated");
+        return v;
+    }
+    template <typename T> vector<T> array() {
+        auto n = pod<uint64_t>();
+        IT_ASSERT(n < (uint64_t(1) << 40) / sizeof(T), path + " is corrupt");
+        vector<T> v(n);
+        in.read(reinterpret_cast<char *>(v.data()), n * sizeof(T));
+        IT_ASSERT(in.good(), path + " is truncated");
+        return v;
+    }
+    string str() {
+        auto v = array<char>();
+        return string(v.begin(), v.end());
+    }
+};
+
+} // namespace
+
+Trace Trace::record(const Ref<NativeCpuRuntimeObj> &runtime, const Plan &plan,
+                    bool snapshotInputs) {
+    IT_ASSERT(!plan->capturesBuffers(),
+              "Traces need one step per operator; disable chain tiling for "
+              "this runtime");
+    const auto &graph = plan->getGraph();
+    Trace trace;
+    trace.isa = plan->getIsa();
+    trace.numThreads = runtime->getThreadPool().getNumThreads();
+
+    std::unordered_map<TensorObj *, uint32_t> index;
+    uintptr_t lowest = UINTPTR_MAX;
+    for (auto &t : graph->getTensors())
+        if (t->hasData())
+            lowest = std::min(lowest, (uintptr_t)t->getRawDataPtr<void *>());
+    for (auto &t : graph->getTensors()) {
+        index[t.get()] = trace.tensors.size();
+        TensorRecord record{t->getDType(), t->getDims()};
+        if (t->hasData())
+            record.offset = (uintptr_t)t->getRawDataPtr<void *>() - lowest;
+        if (snapshotInputs && !t->getSource() && t->hasData()) {
+            auto ptr = t->getRawDataPtr<uint8_t *>();
+            record.snapshot.assign(ptr, ptr + t->getBytes());
+        }
+        trace.tensors.emplace_back(std::move(record));
+    }
+
+    const auto &steps = plan->getSteps();
+    for (size_t i = 0; i < steps.size(); ++i) {
+        auto &op = steps[i].op;
+        StepRecord record{op->getOpType(), encodeAttrs(op)};
+        for (auto &t : op->getInputs())
+            record.inputs.emplace_back(index.at(t.get()));
+        for (auto &t : op->getOutputs())
+            record.outputs.emplace_back(index.at(t.get()));
+        record.kernelName = steps[i].kernelName;
+        auto beg = std::chrono::steady_clock::now();
+        runtime->executeSteps(plan, i, i + 1);
+        record.nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - beg)
+                           .count();
+        trace.steps.emplace_back(std::move(record));
+    }
+    return trace;
+}
+
+void Trace::save(const string &path) const {
+    Writer w(path);
+    w.pod(Magic);
+    w.pod(Version);
+    w.pod<int32_t>((int32_t)isa);
+    w.pod(numThreads);
+    w.pod<uint64_t>(tensors.size());
+    for (auto &t : tensors) {
+        w.pod<int32_t>(t.dtype.getIndex());
+        w.array(t.dims);
+        w.pod(t.offset);
+        w.array(t.snapshot);
+    }
+    w.pod<uint64_t>(steps.size());
+    for (auto &s : steps) {
+        w.str(s.type.toString());
+        w.array(s.attrs);
+        w.array(s.inputs);
+        w.array(s.outputs);
+        w.str(s.kernelName);
+        w.pod(s.nanos);
+    }
+    IT_ASSERT(w.good(), "Cannot write " + path);
+}
+
+Trace Trace::load(const string &path) {
+    Reader r(path);
+    auto magic = r.pod<std::array<char, sizeof(Magic)>>();
+    IT_ASSERT(std::equal(magic.begin(), magic.end(), Magic),
+              path + " is not a trace");
+    auto version = r.pod<uint32_t>();
+    IT_ASSERT(version == Version,
+              path + " has trace version " + std::to_string(version));
+    Trace trace;
+    trace.isa = (CpuIsa)r.pod<int32_t>();
+    trace.numThreads = r.pod<int32_t>();
+    auto numTensors = r.pod<uint64_t>();
+    for (uint64_t i = 0; i < numTensors; ++i) {
+        TensorRecord t;
+        auto dtype = r.pod<int32_t>();
+        IT_ASSERT(dtype >= 0 && dtype < (int32_t)std::size(DataType::names),
+                  path + " is corrupt");
+        t.dtype = DataType(dtype);
+        t.dims = r.array<ShapeElem>();
+        t.offset = r.pod<int64_t>();
+        t.snapshot = r.array<uint8_t>();
+        trace.tensors.emplace_back(std::move(t));
+    }
+    auto numSteps = r.pod<uint64_t>();
+    for (uint64_t i = 0; i < numSteps; ++i) {
+        StepRecord s;
+        auto typeName = r.str();
+        auto type = opTypeByName(typeName);
+        IT_ASSERT(type, path + " has unknown op type " + typeName);
+        s.type = *type;
+        s.attrs = r.array<int64_t>();
+        s.inputs = r.array<uint32_t>();
+        s.outputs = r.array<uint32_t>();
+        for (auto idx : s.inputs)
+            IT_ASSERT(idx < numTensors, path + " is corrupt");
+        for (auto idx : s.outputs)
+            IT_ASSERT(idx < numTensors, path + " is corrupt");
+        s.kernelName = r.str();
+        s.nanos = r.pod<uint64_t>();
+        trace.steps.emplace_back(std::move(s));
+    }
+    return trace;
+}
+
+Graph Trace::rebuild(Runtime runtime) const {
+    Graph g = make_ref<GraphObj>(runtime);
+    TensorVec all;
+    for (auto &t : tensors)
+        all.emplace_back(g->addTensor(t.dims, t.dtype));
+    for (auto &s : steps) {
+        TensorVec in, out;
+        for (auto idx : s.inputs)
+            in.emplace_back(all[idx]);
+        for (auto idx : s.outputs)
+            out.emplace_back(all[idx]);
+        addOp(g, s.type, s.attrs, in, out);
+    }
+    g->dataMalloc();
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        auto &snapshot = tensors[i].snapshot;
+        if (snapshot.empty())
+            continue;
+        IT_ASSERT(snapshot.size() == all[i]->getBytes());
+        std::memcpy(all[i]->getRawDataPtr<void *>(), snapshot.data(),
+                    snapshot.size());
+    }
+    return g;
+}
+
+ReplayResult replayTrace(const Trace &trace,
+                         const Ref<NativeCpuRuntimeObj> &runtime,
+                         const ReplayOptions &options) {
+    IT_ASSERT(options.repeat >= 1);
+    IT_ASSERT(!options.step || *options.step < trace.steps.size(),
+              "The trace has " + std::to_string(trace.steps.size()) +
+                  " steps");
+    ReplayResult result;
+    result.graph = trace.rebuild(runtime);
+    IT_ASSERT(result.graph->topo_sort());
+    runtime->checkKernels(result.graph);
+
+    // Operators of the rebuilt graph in step order
+    std::unordered_map<TensorObj *, Operator> producer;
+    for (auto &op : result.graph->getOperators())
+        producer[op->getOutputs()[0].get()] = op;
+    auto tensors = result.graph->getTensors();
+
+    const auto &registry = KernelRegistry::sealed();
+    vector<PlanObj::Step> steps;
+    for (size_t i = 0; i < trace.steps.size(); ++i) {
+        auto &s = trace.steps[i];
+        auto op = producer.at(tensors.at(s.outputs.at(0)).get());
+        auto &candidates = *registry.findKernels(
+            Device::CPU, op->getOpType().underlying(), op->getDType());
+        string wanted = s.kernelName;
+        if (auto it = options.kernels.find(s.type.toString());
+            it != options.kernels.end())
+            wanted = it->second;
+        const KernelRegistry::KernelRecord *chosen = &candidates.front();
+        bool found = false;
+        for (auto &record : candidates)
+            if (std::get<1>(record) == wanted) {
+                chosen = &record;
+                found = true;
+            }
+        IT_ASSERT(found || !options.kernels.count(s.type.toString()),
+                  "No kernel " + wanted + " for " + op->toString());
+        steps.push_back({op, std::get<0>(*chosen), std::get<1>(*chosen)});
+    }
+    auto plan = make_ref<PlanObj>(result.graph, std::move(steps),
+                                  runtime->getIsa());
+
+    size_t begin = options.step.value_or(0);
+    size_t end = options.step ? begin + 1 : trace.steps.size();
+    // Earlier steps run once, untimed, to produce the inputs of the step
+    runtime->executeSteps(plan, 0, begin);
+    for (size_t i = begin; i < end; ++i) {
+        uint64_t best = UINT64_MAX;
+        for (int r = 0; r < options.repeat; ++r) {
+            auto beg = std::chrono::steady_clock::now();
+            runtime->executeSteps(plan, i, i + 1);
+            best = std::min<uint64_t>(
+                best, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - beg)
+                          .count());
+        }
+        result.steps.emplace_back(i);
+        result.kernelNames.emplace_back(plan->getSteps()[i].kernelName);
+        result.nanos.emplace_back(best);
+    }
+    return result;
+}
+
+} // namespace infini
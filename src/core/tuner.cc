@@ -0,0 +1,141 @@
+#include "core/tuner.h"
+#include "core/thread_pool.h"
+#include "utils/isa_dispatch.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace infini {
+
+// Entries of a cache file, the last line winning for a key
+static map<string, string> readCacheFile(const string &path) {
+    map<string, string> entries;
+    std::ifstream ifs(path);
+    string line;
+    while (std::getline(ifs, line)) {
+        auto tab = line.find('\t');
+        if (tab == string::npos)
+            continue;
+        entries[line.substr(0, tab)] = line.substr(tab + 1);
+    }
+    return entries;
+}
+
+void KernelTuner::setCacheFile(const string &path) {
+    std::lock_guard<std::mutex> lock(mtx);
+    cacheFile = path;
+    load();
+}
+
+void KernelTuner::setRounds(int warmup, int timing) {
+    IT_ASSERT(warmup >= 0 && timing >= 1);
+    std::lock_guard<std::mutex> lock(mtx);
+    warmupRounds = warmup;
+    timingRounds = timing;
+}
+
+void KernelTuner::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    cache.clear();
+}
+
+optional<string> KernelTuner::lookup(const string &key) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = cache.find(key);
+    if (it == cache.end())
+        return std::nullopt;
+    return it->second;
+}
+
+string KernelTuner::getKey(const Operator &op, const RuntimeObj *context) {
+    std::ostringstream oss;
+    oss << op->getOpType().toString() << "|" << op->getDType().toString()
+        << "|";
+    for (auto &input : op->getInputs())
+        oss << vecToString(input->getDims());
+    oss << "->";
+    for (auto &output : op->getOutputs())
+        oss << vecToString(output->getDims());
+    oss << "|" << isaToString(getContextIsa(context)) << "|"
+        << getParallelism(context);
+    return oss.str();
+}
+
+const KernelTuner::KernelRecord &
+KernelTuner::select(const Operator &op, const vector<KernelRecord> &candidates,
+                    const RuntimeObj *context) {
+    IT_ASSERT(!candidates.empty());
+    auto key = getKey(op, context);
+    if (auto name = lookup(key)) {
+        for (auto &record : candidates)
+            if (std::get<1>(record) == *name)
+                return record;
+        // A stale entry naming a kernel that is no longer built in is
+        // re-tuned below.
+    }
+
+    for (auto &t : op->getInputs())
+        if (!t->hasData())
+            return candidates.front();
+    for (auto &t : op->getOutputs())
+        if (!t->hasData())
+            return candidates.front();
+
+    int warmup, timing;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        warmup = warmupRounds;
+        timing = timingRounds;
+    }
+    const KernelRecord *best = nullptr;
+    double bestTime = 0;
+    for (auto &record : candidates) {
+        auto kernel = std::get<0>(record);
+        for (int i = 0; i < warmup; ++i)
+            kernel->compute(op, context);
+        double time = 0;
+        for (int i = 0; i < timing; ++i) {
+            auto beg = std::chrono::steady_clock::now();
+            kernel->compute(op, context);
+            auto end = std::chrono::steady_clock::now();
+            double t = std::chrono::duration<double>(end - beg).count();
+            time = i == 0 ? t : std::min(time, t);
+        }
+        if (!best || time < bestTime) {
+            best = &record;
+            bestTime = time;
+        }
+    }
+    store(key, std::get<1>(*best));
+    return *best;
+}
+
+void KernelTuner::load() {
+    if (cacheFile.empty())
+        return;
+    for (auto &[key, name] : readCacheFile(cacheFile))
+        cache[key] = name;
+}
+
+void KernelTuner::store(const string &key, const string &name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    cache[key] = name;
+    if (cacheFile.empty())
+        return;
+    // Rewritten rather than appended to, so re-tuning a key replaces its
+    // line. Entries of other processes are kept, and the rename means
+    // readers never see a partial file.
+    auto entries = readCacheFile(cacheFile);
+    entries[key] = name;
+    auto tmp = cacheFile + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::trunc);
+        IT_ASSERT(ofs.good(), "Cannot write tuning cache " + tmp);
+        for (auto &[k, v] : entries)
+            ofs << k << '\t' << v << '\n';
+    }
+    IT_ASSERT(std::rename(tmp.c_str(), cacheFile.c_str()) == 0,
+              "Cannot rename " + tmp + " to " + cacheFile);
+}
+
+} // namespace infini
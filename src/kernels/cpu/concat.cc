@@ -3,9 +3,9 @@
 
 namespace infini {
 
-class NaiveConcat : public CpuKernelWithoutConfig {
-    template <typename T>
-    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+template <typename T> class NaiveConcat : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
         auto op = as<ConcatObj>(_op);
         auto inputs = op->getInputs(), outputs = op->getOutputs();
         auto dim = op->getDim();
@@ -32,33 +32,22 @@ class NaiveConcat : public CpuKernelWithoutConfig {
             auto inSize = input->size();
             auto inPtr = input->getRawDataPtr<T *>(),
                  outPtr = output->getRawDataPtr<T *>();
-#pragma omp parallel for
-            for (size_t iOffset = 0; iOffset < inSize; ++iOffset) {
-                auto oOffset = iOffset % localBlockOffset + innerOffset +
-                               iOffset / localBlockOffset * blockOffset;
-                outPtr[oOffset] = inPtr[iOffset];
-            }
-        }
-    }
-
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-#define CASE(N)                                                                \
-    case N:                                                                    \
-        doCompute<DT<N>::t>(_op, context)
-
-        int dataTypeIdx = _op->getDType().getIndex();
-        switch (dataTypeIdx) {
-            CASE(1); // DataType::Float32
-            break;
-            CASE(12); // DataType::UInt32
-            break;
-        default:
-            IT_TODO_HALT();
+            parallelFor(
+                context, inSize,
+                [&](size_t begin, size_t end) {
+                    for (size_t iOffset = begin; iOffset < end; ++iOffset) {
+                        auto oOffset = iOffset % localBlockOffset +
+                                       innerOffset +
+                                       iOffset / localBlockOffset * blockOffset;
+                        outPtr[oOffset] = inPtr[iOffset];
+                    }
+                },
+                4096);
         }
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Concat, NaiveConcat, "ConcatNaive_CPU");
+REGISTER_KERNEL_TYPED(Device::CPU, OpType::Concat, NaiveConcat,
+                      "ConcatNaive_CPU", 1 /* Float32 */, 12 /* UInt32 */);
 
 } // namespace infini
@@ -1,37 +1,83 @@
 #include "operators/element_wise.h"
 #include "core/kernel.h"
+#include "utils/isa_dispatch.h"
 #include "utils/operator_utils.h"
 
 namespace infini
 {
+    template <OpType::underlying_t type>
+    static IT_ALWAYS_INLINE void binaryBody(const float *a, const float *b,
+                                            float *c, size_t n)
+    {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+        {
+            if constexpr (type == OpType::Add)
+                c[i] = a[i] + b[i];
+            else if constexpr (type == OpType::Sub)
+                c[i] = a[i] - b[i];
+            else if constexpr (type == OpType::Mul)
+                c[i] = a[i] * b[i];
+            else
+                c[i] = a[i] / b[i];
+        }
+    }
+
+#define DEFINE_BINARY_VARIANTS(name, type)                                     \
+    IT_DEFINE_ISA_VARIANTS(name, binaryBody<type>, void,                       \
+                           (const float *a, const float *b, float *c,          \
+                            size_t n),                                         \
+                           (a, b, c, n))
+    DEFINE_BINARY_VARIANTS(addF32, OpType::Add)
+    DEFINE_BINARY_VARIANTS(subF32, OpType::Sub)
+    DEFINE_BINARY_VARIANTS(mulF32, OpType::Mul)
+    DEFINE_BINARY_VARIANTS(divF32, OpType::Div)
+#undef DEFINE_BINARY_VARIANTS
+
+    template <typename T>
     class NativeElementWise : public CpuKernelWithoutConfig
     {
-        template <typename T>
+    protected:
         static T addCompute(T val0, T val1)
         {
             return val0 + val1;
         }
 
-        template <typename T>
         static T subCompute(T val0, T val1)
         {
             return val0 - val1;
         }
 
-        template <typename T>
         static T mulCompute(T val0, T val1)
         {
             return val0 * val1;
         }
 
-        template <typename T>
         static T divCompute(T val0, T val1)
         {
             return (T)(val0 / val1);
         }
 
-        template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        static auto getCompute(OpType type) -> T (*)(T, T)
+        {
+            switch (type.underlying())
+            {
+            case OpType::Add:
+                return addCompute;
+            case OpType::Sub:
+                return subCompute;
+            case OpType::Mul:
+                return mulCompute;
+            case OpType::Div:
+                return divCompute;
+            default:
+                IT_TODO_HALT();
+            }
+        }
+
+    private:
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
         {
             auto op = as<ElementWiseObj>(_op);
             T *inptr0 = op->getInputs(0)->getRawDataPtr<T *>();
@@ -63,25 +109,7 @@ namespace infini
             Shape strideB = getStride(b);
 
             auto n = op->getOutput()->size();
-            T (*_doCompute)
-            (T val0, T val1);
-            switch (op->getOpType().underlying())
-            {
-            case OpType::Add:
-                _doCompute = addCompute<T>;
-                break;
-            case OpType::Sub:
-                _doCompute = subCompute<T>;
-                break;
-            case OpType::Mul:
-                _doCompute = mulCompute<T>;
-                break;
-            case OpType::Div:
-                _doCompute = divCompute<T>;
-                break;
-            default:
-                IT_TODO_HALT();
-            }
+            auto _doCompute = getCompute(op->getOpType());
 
             for (size_t i = 0; i < n; ++i)
             {
@@ -91,29 +119,120 @@ namespace infini
                 outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
             }
         }
+    };
 
+    /**
+     * @brief Broadcast-aware element-wise kernel that walks the output with an
+     * odometer over precomputed input strides (0 on broadcast dims) instead of
+     * decomposing every linear index. Registered as a tuning candidate next to
+     * NativeElementWise.
+     */
+    template <typename T>
+    class StridedElementWise : public NativeElementWise<T>
+    {
         void compute(const Operator &_op,
                      const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
+            auto op = as<ElementWiseObj>(_op);
+            T *inptr0 = op->getInputs(0)->getRawDataPtr<T *>();
+            T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
+            T *outptr = op->getOutput()->getRawDataPtr<T *>();
+            auto _doCompute = NativeElementWise<T>::getCompute(op->getOpType());
 
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
+            auto shapeC = op->getOutput()->getDims();
+            int rank = shapeC.size();
+            // Broadcast stride of each output dim in an input, 0 if broadcast
+            auto getStride = [&](const Shape &shape)
             {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
+                vector<size_t> stride(rank, 0);
+                size_t p = 1;
+                int offset = rank - shape.size();
+                for (int i = shape.size() - 1; i >= 0; --i)
+                {
+                    stride[i + offset] = shape[i] == 1 ? 0 : p;
+                    p *= shape[i];
+                }
+                return stride;
+            };
+            auto strideA = getStride(op->getInputs(0)->getDims());
+            auto strideB = getStride(op->getInputs(1)->getDims());
+
+            auto n = op->getOutput()->size();
+            if (n == 0)
+                return;
+            if (rank == 0)
+            {
+                outptr[0] = _doCompute(inptr0[0], inptr1[0]);
+                return;
+            }
+            size_t inner = shapeC[rank - 1];
+            size_t sA = strideA[rank - 1], sB = strideB[rank - 1];
+            // Rows that are contiguous in both inputs use the SIMD variant of
+            // the host's ISA level
+            void (*simdRow)(const float *, const float *, float *, size_t) =
+                nullptr;
+            if constexpr (std::is_same_v<T, float>)
+            {
+                auto isa = getContextIsa(context);
+                if (sA == 1 && sB == 1)
+                    switch (op->getOpType().underlying())
+                    {
+                    case OpType::Add:
+                        simdRow = addF32.get(isa);
+                        break;
+                    case OpType::Sub:
+                        simdRow = subF32.get(isa);
+                        break;
+                    case OpType::Mul:
+                        simdRow = mulF32.get(isa);
+                        break;
+                    case OpType::Div:
+                        simdRow = divF32.get(isa);
+                        break;
+                    }
+            }
+            vector<int> index(rank, 0);
+            size_t offA = 0, offB = 0;
+            for (size_t i = 0; i < n; i += inner)
+            {
+                if constexpr (std::is_same_v<T, float>)
+                    if (simdRow)
+                        simdRow(inptr0 + offA, inptr1 + offB, outptr + i, inner);
+                if (!simdRow)
+                    for (size_t j = 0; j < inner; ++j)
+                        outptr[i + j] = _doCompute(inptr0[offA + j * sA],
+                                                   inptr1[offB + j * sB]);
+                // Advance the odometer over the outer dims
+                for (int d = rank - 2; d >= 0; --d)
+                {
+                    offA += strideA[d];
+                    offB += strideB[d];
+                    if (++index[d] < shapeC[d])
+                        break;
+                    offA -= strideA[d] * shapeC[d];
+                    offB -= strideB[d] * shapeC[d];
+                    index[d] = 0;
+                }
             }
         }
     };
 
-    REGISTER_KERNEL(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Sub, NativeElementWise, "subNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Mul, NativeElementWise, "mulNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Div, NativeElementWise, "divNaive_CPU");
+    // The first registration of a key is its default kernel. Data types are
+    // DT<N> indices: 1 is Float32, 12 is UInt32.
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Add, NativeElementWise,
+                          "addNaive_CPU", 1, 12);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Sub, NativeElementWise,
+                          "subNaive_CPU", 1, 12);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Mul, NativeElementWise,
+                          "mulNaive_CPU", 1, 12);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Div, NativeElementWise,
+                          "divNaive_CPU", 1, 12);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Add, StridedElementWise,
+                          "addStrided_CPU", 1, 12);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Sub, StridedElementWise,
+                          "subStrided_CPU", 1, 12);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Mul, StridedElementWise,
+                          "mulStrided_CPU", 1, 12);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Div, StridedElementWise,
+                          "divStrided_CPU", 1, 12);
 }; // namespace infini
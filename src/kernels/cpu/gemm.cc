@@ -0,0 +1,784 @@
+#include "kernels/cpu/gemm.h"
+#include "utils/isa_dispatch.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace infini {
+
+namespace {
+
+// Depth of a packed panel and rows of a packed A block; a kc x nr strip of B
+// stays in L1 while an mc x kc block of A stays in L2
+constexpr size_t KC = 256;
+constexpr size_t MC = 96;
+constexpr size_t NC = 2048;
+
+// Computes the mr x nr tile c (row stride ldc) from packed strips: `a` holds
+// kc columns of mr values, `b` kc rows of nr values. Adds to c when
+// `accumulate`, overwrites it otherwise.
+using MicroKernel = void (*)(size_t kc, const float *a, const float *b,
+                             float *c, size_t ldc, bool accumulate);
+
+template <size_t MR, size_t NR>
+static IT_ALWAYS_INLINE void microBody(size_t kc, const float *a,
+                                       const float *b, float *c, size_t ldc,
+                                       bool accumulate) {
+    float acc[MR][NR] = {};
+    for (size_t p = 0; p < kc; ++p, a += MR, b += NR)
+        for (size_t r = 0; r < MR; ++r)
+#pragma omp simd
+            for (size_t j = 0; j < NR; ++j)
+                acc[r][j] += a[r] * b[j];
+    for (size_t r = 0; r < MR; ++r)
+        for (size_t j = 0; j < NR; ++j)
+            c[r * ldc + j] =
+                accumulate ? c[r * ldc + j] + acc[r][j] : acc[r][j];
+}
+
+static void microScalar(size_t kc, const float *a, const float *b, float *c,
+                        size_t ldc, bool accumulate) {
+    microBody<4, 8>(kc, a, b, c, ldc, accumulate);
+}
+
+IT_TARGET_SSE4 static void microSse4(size_t kc, const float *a,
+                                     const float *b, float *c, size_t ldc,
+                                     bool accumulate) {
+    microBody<4, 8>(kc, a, b, c, ldc, accumulate);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// 6 x 16: 12 accumulators, 2 B vectors and a broadcast of 16 ymm registers
+IT_TARGET_AVX2 static void microAvx2(size_t kc, const float *a,
+                                     const float *b, float *c, size_t ldc,
+                                     bool accumulate) {
+    __m256 acc[6][2];
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; ++r)
+        acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+    for (size_t p = 0; p < kc; ++p, a += 6, b += 16) {
+        __m256 b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < 6; ++r) {
+            __m256 av = _mm256_broadcast_ss(a + r);
+            acc[r][0] = _mm256_fmadd_ps(av, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(av, b1, acc[r][1]);
+        }
+    }
+#pragma GCC unroll 6
+    for (int r = 0; r < 6; ++r) {
+        float *row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm256_add_ps(acc[r][0], _mm256_loadu_ps(row));
+            acc[r][1] = _mm256_add_ps(acc[r][1], _mm256_loadu_ps(row + 8));
+        }
+        _mm256_storeu_ps(row, acc[r][0]);
+        _mm256_storeu_ps(row + 8, acc[r][1]);
+    }
+}
+
+// 8 x 32: 16 accumulators of 32 zmm registers
+IT_TARGET_AVX512 static void microAvx512(size_t kc, const float *a,
+                                         const float *b, float *c, size_t ldc,
+                                         bool accumulate) {
+    __m512 acc[8][2];
+#pragma GCC unroll 8
+    for (int r = 0; r < 8; ++r)
+        acc[r][0] = acc[r][1] = _mm512_setzero_ps();
+    for (size_t p = 0; p < kc; ++p, a += 8, b += 32) {
+        __m512 b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+#pragma GCC unroll 8
+        for (int r = 0; r < 8; ++r) {
+            __m512 av = _mm512_set1_ps(a[r]);
+            acc[r][0] = _mm512_fmadd_ps(av, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(av, b1, acc[r][1]);
+        }
+    }
+#pragma GCC unroll 8
+    for (int r = 0; r < 8; ++r) {
+        float *row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm512_add_ps(acc[r][0], _mm512_loadu_ps(row));
+            acc[r][1] = _mm512_add_ps(acc[r][1], _mm512_loadu_ps(row + 16));
+        }
+        _mm512_storeu_ps(row, acc[r][0]);
+        _mm512_storeu_ps(row + 16, acc[r][1]);
+    }
+}
+#endif
+
+struct Micro {
+    size_t mr, nr;
+    MicroKernel fn;
+};
+
+Micro selectMicro(CpuIsa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (isa >= CpuIsa::AVX512)
+        return {8, 32, microAvx512};
+    if (isa >= CpuIsa::AVX2)
+        return {6, 16, microAvx2};
+#endif
+    if (isa >= CpuIsa::SSE4)
+        return {4, 8, microSse4};
+    return {4, 8, microScalar};
+}
+
+// Packs op(A)[i0 : i0 + mc, p0 : p0 + kc] into strips of mr rows: strip s
+// holds, for each p, the mr values of rows s * mr ... (zero past mc).
+void packA(bool transA, const float *A, size_t lda, size_t i0, size_t mc,
+           size_t p0, size_t kc, size_t mr, float *out) {
+    for (size_t s = 0; s < mc; s += mr) {
+        size_t rows = std::min(mr, mc - s);
+        for (size_t p = 0; p < kc; ++p, out += mr) {
+            for (size_t r = 0; r < rows; ++r) {
+                size_t i = i0 + s + r, q = p0 + p;
+                out[r] = transA ? A[q * lda + i] : A[i * lda + q];
+            }
+            std::fill(out + rows, out + mr, 0.f);
+        }
+    }
+}
+
+// Packs op(B)[p0 : p0 + kc, j0 : j0 + nc] into strips of nr columns: strip s
+// holds, for each p, the nr values of columns s * nr ... (zero past nc).
+void packB(bool transB, const float *B, size_t ldb, size_t p0, size_t kc,
+           size_t j0, size_t nc, size_t nr, float *out) {
+    for (size_t s = 0; s < nc; s += nr) {
+        size_t cols = std::min(nr, nc - s);
+        for (size_t p = 0; p < kc; ++p, out += nr) {
+            size_t q = p0 + p, j = j0 + s;
+            if (transB)
+                for (size_t c = 0; c < cols; ++c)
+                    out[c] = B[(j + c) * ldb + q];
+            else
+                std::copy(B + q * ldb + j, B + q * ldb + j + cols, out);
+            std::fill(out + cols, out + nr, 0.f);
+        }
+    }
+}
+
+// fp16 bits to fp32. With the exponent and mantissa shifted into place,
+// scaling by 2^112 rebiases the exponent and turns subnormal halves into
+// normal floats; only infinities and NaNs need their exponent set.
+static IT_ALWAYS_INLINE float halfToFloat(uint16_t h) {
+    uint32_t bits = uint32_t(h & 0x7fff) << 13;
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    f *= 0x1p112f;
+    std::memcpy(&bits, &f, sizeof(f));
+    if ((h & 0x7c00) == 0x7c00)
+        bits |= 0x7f800000;
+    bits |= uint32_t(h & 0x8000) << 16;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static IT_ALWAYS_INLINE void widenF16Body(const uint16_t *src, float *dst,
+                                          size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        dst[i] = halfToFloat(src[i]);
+}
+
+// bf16 is the upper half of an fp32
+static IT_ALWAYS_INLINE void widenBf16Body(const uint16_t *src, float *dst,
+                                           size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t bits = uint32_t(src[i]) << 16;
+        std::memcpy(dst + i, &bits, sizeof(bits));
+    }
+}
+
+#define DEFINE_WIDEN_VARIANTS(name, body)                                      \
+    IT_DEFINE_ISA_VARIANTS(name, body, void,                                   \
+                           (const uint16_t *src, float *dst, size_t n),        \
+                           (src, dst, n))
+DEFINE_WIDEN_VARIANTS(widenF16, widenF16Body)
+DEFINE_WIDEN_VARIANTS(widenBf16, widenBf16Body)
+#undef DEFINE_WIDEN_VARIANTS
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IT_TARGET_F16C __attribute__((target("avx2,fma,f16c")))
+
+IT_TARGET_F16C static void widenF16C(const uint16_t *src, float *dst,
+                                     size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    for (; i < n; ++i)
+        dst[i] = halfToFloat(src[i]);
+}
+
+IT_TARGET_AVX512 static void widenF16Avx512(const uint16_t *src, float *dst,
+                                            size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        auto h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        // The maskz form: _mm512_cvtph_ps() trips -Wmaybe-uninitialized
+        _mm512_storeu_ps(dst + i, _mm512_maskz_cvtph_ps(0xffff, h));
+    }
+    for (; i < n; ++i)
+        dst[i] = halfToFloat(src[i]);
+}
+#endif
+
+// Widens n contiguous 16-bit floats to fp32
+using WidenFn = void (*)(const uint16_t *src, float *dst, size_t n);
+
+WidenFn selectWiden(CpuIsa isa, HalfType type) {
+    if (type == HalfType::BFloat16)
+        return widenBf16.get(isa);
+#if defined(__x86_64__) || defined(__i386__)
+    // AVX-512F implies F16C
+    if (isa >= CpuIsa::AVX512)
+        return widenF16Avx512;
+    if (isa >= CpuIsa::AVX2 && getCpuFeatures().f16c)
+        return widenF16C;
+#endif
+    return widenF16.get(isa);
+}
+
+// packB() from 16-bit storage. Rows of B are widened straight into the
+// strip; with transB each column is a contiguous run of kc values, widened
+// once and then scattered.
+void packB(bool transB, const uint16_t *B, WidenFn widen, size_t ldb,
+           size_t p0, size_t kc, size_t j0, size_t nc, size_t nr,
+           float *out) {
+    float column[KC];
+    for (size_t s = 0; s < nc; s += nr, out += kc * nr) {
+        size_t cols = std::min(nr, nc - s), j = j0 + s;
+        if (transB) {
+            for (size_t c = 0; c < cols; ++c) {
+                widen(B + (j + c) * ldb + p0, column, kc);
+                for (size_t p = 0; p < kc; ++p)
+                    out[p * nr + c] = column[p];
+            }
+        }
+        for (size_t p = 0; p < kc; ++p) {
+            if (!transB)
+                widen(B + (p0 + p) * ldb + j, out + p * nr, cols);
+            std::fill(out + p * nr + cols, out + (p + 1) * nr, 0.f);
+        }
+    }
+}
+
+// Columns of y accumulated together, small enough to stay in L1
+constexpr size_t GemvCols = 512;
+
+// y = x * W for a k x n W: four rows of W per pass over a block of y
+static IT_ALWAYS_INLINE void gemvRowsBody(size_t n, size_t k, const float *x,
+                                          const float *W, size_t ldw,
+                                          float *y) {
+    for (size_t j0 = 0; j0 < n; j0 += GemvCols) {
+        size_t cols = std::min(GemvCols, n - j0);
+        float *yb = y + j0;
+        std::fill(yb, yb + cols, 0.f);
+        size_t p = 0;
+        for (; p + 4 <= k; p += 4) {
+            const float *w0 = W + p * ldw + j0, *w1 = w0 + ldw,
+                        *w2 = w1 + ldw, *w3 = w2 + ldw;
+            float x0 = x[p], x1 = x[p + 1], x2 = x[p + 2], x3 = x[p + 3];
+#pragma omp simd
+            for (size_t j = 0; j < cols; ++j)
+                yb[j] += x0 * w0[j] + x1 * w1[j] + x2 * w2[j] + x3 * w3[j];
+        }
+        for (; p < k; ++p) {
+            const float *w = W + p * ldw + j0;
+            float xp = x[p];
+#pragma omp simd
+            for (size_t j = 0; j < cols; ++j)
+                yb[j] += xp * w[j];
+        }
+    }
+}
+
+// y = x * W^T for an n x k W: four dot products at a time, x shared
+static IT_ALWAYS_INLINE void gemvDotsBody(size_t n, size_t k, const float *x,
+                                          const float *W, size_t ldw,
+                                          float *y) {
+    constexpr size_t L = 16; // Independent partial sums per row
+    size_t kv = k / L * L, j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const float *w[4] = {W + j * ldw, W + (j + 1) * ldw,
+                             W + (j + 2) * ldw, W + (j + 3) * ldw};
+        float acc[4][L] = {};
+        for (size_t p = 0; p < kv; p += L)
+            for (int r = 0; r < 4; ++r)
+#pragma omp simd
+                for (size_t l = 0; l < L; ++l)
+                    acc[r][l] += x[p + l] * w[r][p + l];
+        for (int r = 0; r < 4; ++r) {
+            float sum = 0;
+            for (size_t l = 0; l < L; ++l)
+                sum += acc[r][l];
+            for (size_t p = kv; p < k; ++p)
+                sum += x[p] * w[r][p];
+            y[j + r] = sum;
+        }
+    }
+    for (; j < n; ++j) {
+        const float *w = W + j * ldw;
+        float acc[L] = {};
+        for (size_t p = 0; p < kv; p += L)
+#pragma omp simd
+            for (size_t l = 0; l < L; ++l)
+                acc[l] += x[p + l] * w[p + l];
+        float sum = 0;
+        for (size_t l = 0; l < L; ++l)
+            sum += acc[l];
+        for (size_t p = kv; p < k; ++p)
+            sum += x[p] * w[p];
+        y[j] = sum;
+    }
+}
+
+#define DEFINE_GEMV_VARIANTS(name, body)                                       \
+    IT_DEFINE_ISA_VARIANTS(name, body, void,                                   \
+                           (size_t n, size_t k, const float *x,                \
+                            const float *W, size_t ldw, float *y),             \
+                           (n, k, x, W, ldw, y))
+DEFINE_GEMV_VARIANTS(gemvRows, gemvRowsBody)
+DEFINE_GEMV_VARIANTS(gemvDots, gemvDotsBody)
+#undef DEFINE_GEMV_VARIANTS
+
+// Vector types of L lanes for the 16-bit GEMVs
+template <size_t L> struct Lanes {
+    typedef float F __attribute__((vector_size(L * sizeof(float))));
+    typedef uint32_t U __attribute__((vector_size(L * sizeof(uint32_t))));
+    typedef uint16_t H __attribute__((vector_size(L * sizeof(uint16_t))));
+};
+
+// Loaders of 16-bit weights for the GEMV bodies below: load() widens L
+// contiguous values into a vector, one() a single value. Vectors are passed
+// by reference, as returning them from a function without the matching
+// target would change the ABI.
+template <size_t Lanes_> struct LoadBf16 {
+    static constexpr size_t L = Lanes_;
+    using V = Lanes<L>;
+    static IT_ALWAYS_INLINE void load(const uint16_t *p, typename V::F &f) {
+        typename V::H h;
+        std::memcpy(&h, p, sizeof(h));
+        f = (typename V::F)(__builtin_convertvector(h, typename V::U) << 16);
+    }
+    static IT_ALWAYS_INLINE float one(uint16_t h) {
+        uint32_t bits = uint32_t(h) << 16;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+};
+
+// halfToFloat() on L lanes, for hosts without F16C
+template <size_t Lanes_> struct LoadF16 {
+    static constexpr size_t L = Lanes_;
+    using V = Lanes<L>;
+    static IT_ALWAYS_INLINE void load(const uint16_t *p, typename V::F &f) {
+        typename V::H h;
+        std::memcpy(&h, p, sizeof(h));
+        auto u = __builtin_convertvector(h, typename V::U);
+        f = (typename V::F)((u & 0x7fff) << 13) * 0x1p112f;
+        auto special = (typename V::U)((u & 0x7c00) == 0x7c00);
+        f = (typename V::F)((typename V::U)f | (special & 0x7f800000) |
+                            ((u & 0x8000) << 16));
+    }
+    static IT_ALWAYS_INLINE float one(uint16_t h) { return halfToFloat(h); }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+// The F16C loaders are not always_inline: the bodies they are passed to
+// have no target of their own, and the flattened wrappers inline them
+struct LoadF16C {
+    static constexpr size_t L = 8;
+    IT_TARGET_F16C static inline void load(const uint16_t *p,
+                                           Lanes<8>::F &f) {
+        auto h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        f = (Lanes<8>::F)_mm256_cvtph_ps(h);
+    }
+    static IT_ALWAYS_INLINE float one(uint16_t h) { return halfToFloat(h); }
+};
+
+struct LoadF16Avx512 {
+    static constexpr size_t L = 16;
+    IT_TARGET_AVX512 static inline void load(const uint16_t *p,
+                                             Lanes<16>::F &f) {
+        auto h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        f = (Lanes<16>::F)_mm512_maskz_cvtph_ps(0xffff, h);
+    }
+    static IT_ALWAYS_INLINE float one(uint16_t h) { return halfToFloat(h); }
+};
+#endif
+
+// yb[0 : cols] += x[0 : R] * W[0 : R, 0 : cols] for a 16-bit W
+template <class Load, size_t R>
+static IT_ALWAYS_INLINE void axpyHalf(size_t cols, const float *x,
+                                      const uint16_t *W, size_t ldw,
+                                      float *yb) {
+    constexpr size_t L = Load::L;
+    using F = typename Lanes<L>::F;
+    size_t j = 0;
+    for (; j + L <= cols; j += L) {
+        F acc;
+        std::memcpy(&acc, yb + j, sizeof(acc));
+#pragma GCC unroll 4
+        for (size_t r = 0; r < R; ++r) {
+            F v;
+            Load::load(W + r * ldw + j, v);
+            acc += x[r] * v;
+        }
+        std::memcpy(yb + j, &acc, sizeof(acc));
+    }
+    for (; j < cols; ++j)
+        for (size_t r = 0; r < R; ++r)
+            yb[j] += x[r] * Load::one(W[r * ldw + j]);
+}
+
+// gemvRowsBody() on a 16-bit W. Each vector of W is widened in registers
+// right before its FMA, so W is streamed once at half the bytes.
+template <class Load>
+static IT_ALWAYS_INLINE void gemvRowsHalfBody(size_t n, size_t k,
+                                              const float *x,
+                                              const uint16_t *W, size_t ldw,
+                                              float *y) {
+    for (size_t j0 = 0; j0 < n; j0 += GemvCols) {
+        size_t cols = std::min(GemvCols, n - j0);
+        std::fill(y + j0, y + j0 + cols, 0.f);
+        size_t p = 0;
+        for (; p + 4 <= k; p += 4)
+            axpyHalf<Load, 4>(cols, x + p, W + p * ldw + j0, ldw, y + j0);
+        for (; p < k; ++p)
+            axpyHalf<Load, 1>(cols, x + p, W + p * ldw + j0, ldw, y + j0);
+    }
+}
+
+// y[0 : R] = dot products of x with R rows of a 16-bit W, two vectors of
+// partial sums per row
+template <class Load, size_t R>
+static IT_ALWAYS_INLINE void dotsHalf(size_t k, const float *x,
+                                      const uint16_t *const *w, float *y) {
+    constexpr size_t L = Load::L;
+    using F = typename Lanes<L>::F;
+    size_t kv = k / (2 * L) * (2 * L);
+    F acc[R][2] = {};
+    for (size_t p = 0; p < kv; p += 2 * L) {
+        F x0, x1;
+        std::memcpy(&x0, x + p, sizeof(x0));
+        std::memcpy(&x1, x + p + L, sizeof(x1));
+#pragma GCC unroll 4
+        for (size_t r = 0; r < R; ++r) {
+            F v0, v1;
+            Load::load(w[r] + p, v0);
+            Load::load(w[r] + p + L, v1);
+            acc[r][0] += x0 * v0;
+            acc[r][1] += x1 * v1;
+        }
+    }
+    for (size_t r = 0; r < R; ++r) {
+        F v = acc[r][0] + acc[r][1];
+        float sum = 0;
+        for (size_t l = 0; l < L; ++l)
+            sum += v[l];
+        for (size_t p = kv; p < k; ++p)
+            sum += x[p] * Load::one(w[r][p]);
+        y[r] = sum;
+    }
+}
+
+// gemvDotsBody() on a 16-bit W, widened in registers like gemvRowsHalfBody()
+template <class Load>
+static IT_ALWAYS_INLINE void gemvDotsHalfBody(size_t n, size_t k,
+                                              const float *x,
+                                              const uint16_t *W, size_t ldw,
+                                              float *y) {
+    size_t j = 0;
+    for (; j + 4 <= n; j += 4) {
+        const uint16_t *w[4] = {W + j * ldw, W + (j + 1) * ldw,
+                                W + (j + 2) * ldw, W + (j + 3) * ldw};
+        dotsHalf<Load, 4>(k, x, w, y + j);
+    }
+    for (; j < n; ++j) {
+        const uint16_t *w = W + j * ldw;
+        dotsHalf<Load, 1>(k, x, &w, y + j);
+    }
+}
+
+using HalfGemv = void (*)(size_t n, size_t k, const float *x,
+                          const uint16_t *W, size_t ldw, float *y);
+
+// name##Rows and name##Dots compiled for `target` with loader `load`
+#define DEFINE_HALF_GEMV(name, target, load)                                   \
+    target __attribute__((flatten)) static void name##Rows(                    \
+        size_t n, size_t k, const float *x, const uint16_t *W, size_t ldw,     \
+        float *y) {                                                            \
+        gemvRowsHalfBody<load>(n, k, x, W, ldw, y);                            \
+    }                                                                          \
+    target __attribute__((flatten)) static void name##Dots(                    \
+        size_t n, size_t k, const float *x, const uint16_t *W, size_t ldw,     \
+        float *y) {                                                            \
+        gemvDotsHalfBody<load>(n, k, x, W, ldw, y);                            \
+    }
+DEFINE_HALF_GEMV(bf16Scalar, , LoadBf16<4>)
+DEFINE_HALF_GEMV(bf16Sse4, IT_TARGET_SSE4, LoadBf16<4>)
+DEFINE_HALF_GEMV(bf16Avx2, IT_TARGET_AVX2, LoadBf16<8>)
+DEFINE_HALF_GEMV(bf16Avx512, IT_TARGET_AVX512, LoadBf16<16>)
+DEFINE_HALF_GEMV(f16Scalar, , LoadF16<4>)
+DEFINE_HALF_GEMV(f16Sse4, IT_TARGET_SSE4, LoadF16<4>)
+DEFINE_HALF_GEMV(f16Avx2, IT_TARGET_AVX2, LoadF16<8>)
+#if defined(__x86_64__) || defined(__i386__)
+DEFINE_HALF_GEMV(f16cAvx2, IT_TARGET_F16C, LoadF16C)
+DEFINE_HALF_GEMV(f16Avx512, IT_TARGET_AVX512, LoadF16Avx512)
+#endif
+#undef DEFINE_HALF_GEMV
+
+HalfGemv selectHalfGemv(CpuIsa isa, HalfType type, bool transW) {
+#define PICK(name) return transW ? name##Dots : name##Rows
+    bool bf16 = type == HalfType::BFloat16;
+#if defined(__x86_64__) || defined(__i386__)
+    if (isa >= CpuIsa::AVX512) {
+        if (bf16)
+            PICK(bf16Avx512);
+        PICK(f16Avx512);
+    }
+    if (isa >= CpuIsa::AVX2) {
+        if (bf16)
+            PICK(bf16Avx2);
+        if (getCpuFeatures().f16c)
+            PICK(f16cAvx2);
+        PICK(f16Avx2);
+    }
+#endif
+    if (isa >= CpuIsa::SSE4) {
+        if (bf16)
+            PICK(bf16Sse4);
+        PICK(f16Sse4);
+    }
+    if (bf16)
+        PICK(bf16Scalar);
+    PICK(f16Scalar);
+#undef PICK
+}
+
+// Rows [i, i + Rows) of C[m x N] = A[m x K] * B[K x N] with N and K known at
+// compile time and B contiguous. A is read as A[i * rsA + p * csA], which
+// covers transA. The loop over K is unrolled completely; the accumulators are
+// generic vectors of V floats, the widest that divides N and fits the
+// target's registers (`W` floats), so they stay in registers, and the rows
+// share the loads of B.
+template <size_t N, size_t K, size_t W, size_t Rows>
+static IT_ALWAYS_INLINE void smallRows(size_t i, const float *A, size_t rsA,
+                                       size_t csA, const float *B, float *C,
+                                       size_t ldc) {
+    constexpr size_t V = std::gcd(N, W);
+    typedef float Vec __attribute__((vector_size(V * sizeof(float))));
+    Vec acc[Rows][N / V] = {};
+#pragma GCC unroll 64
+    for (size_t p = 0; p < K; ++p) {
+#pragma GCC unroll 4
+        for (size_t q = 0; q < Rows; ++q) {
+            float a = A[(i + q) * rsA + p * csA];
+#pragma GCC unroll 16
+            for (size_t v = 0; v < N / V; ++v) {
+                Vec b;
+                std::memcpy(&b, B + p * N + v * V, sizeof(b));
+                acc[q][v] += a * b;
+            }
+        }
+    }
+    for (size_t q = 0; q < Rows; ++q)
+        std::memcpy(C + (i + q) * ldc, acc[q], sizeof(acc[q]));
+}
+
+// Up to 4 rows at a time while their accumulators take at most 8 registers
+template <size_t N, size_t K, size_t W>
+static IT_ALWAYS_INLINE void smallBody(size_t m, const float *A, size_t rsA,
+                                       size_t csA, const float *B, float *C,
+                                       size_t ldc) {
+    constexpr size_t R = std::clamp<size_t>(8 * std::gcd(N, W) / N, 1, 4);
+    size_t i = 0;
+    for (; i + R <= m; i += R)
+        smallRows<N, K, W, R>(i, A, rsA, csA, B, C, ldc);
+    for (; i < m; ++i)
+        smallRows<N, K, W, 1>(i, A, rsA, csA, B, C, ldc);
+}
+
+using SmallKernel = void (*)(size_t m, const float *A, size_t rsA, size_t csA,
+                             const float *B, float *C, size_t ldc);
+
+template <size_t N, size_t K>
+static void smallScalar(size_t m, const float *A, size_t rsA, size_t csA,
+                        const float *B, float *C, size_t ldc) {
+    smallBody<N, K, 4>(m, A, rsA, csA, B, C, ldc);
+}
+template <size_t N, size_t K>
+IT_TARGET_SSE4 static void smallSse4(size_t m, const float *A, size_t rsA,
+                                     size_t csA, const float *B, float *C,
+                                     size_t ldc) {
+    smallBody<N, K, 4>(m, A, rsA, csA, B, C, ldc);
+}
+template <size_t N, size_t K>
+IT_TARGET_AVX2 static void smallAvx2(size_t m, const float *A, size_t rsA,
+                                     size_t csA, const float *B, float *C,
+                                     size_t ldc) {
+    smallBody<N, K, 8>(m, A, rsA, csA, B, C, ldc);
+}
+template <size_t N, size_t K>
+IT_TARGET_AVX512 static void smallAvx512(size_t m, const float *A,
+                                         size_t rsA, size_t csA,
+                                         const float *B, float *C,
+                                         size_t ldc) {
+    smallBody<N, K, 16>(m, A, rsA, csA, B, C, ldc);
+}
+
+// Specialized sizes: N and K each a power of two or three times one, from 4
+// to 64; M up to 64. The other multiples of 4 (20, 28, 36, ...) would double
+// the instantiations for shapes models rarely have.
+constexpr size_t SmallMaxM = 64, SmallSizes = 8;
+constexpr size_t smallSizes[SmallSizes] = {4, 8, 12, 16, 24, 32, 48, 64};
+#define SMALL_ROW(fn, N)                                                       \
+    {                                                                          \
+        fn<N, 4>, fn<N, 8>, fn<N, 12>, fn<N, 16>, fn<N, 24>, fn<N, 32>,        \
+            fn<N, 48>, fn<N, 64>                                               \
+    }
+#define SMALL_TABLE(fn)                                                        \
+    {                                                                          \
+        SMALL_ROW(fn, 4), SMALL_ROW(fn, 8), SMALL_ROW(fn, 12),                 \
+            SMALL_ROW(fn, 16), SMALL_ROW(fn, 24), SMALL_ROW(fn, 32),           \
+            SMALL_ROW(fn, 48), SMALL_ROW(fn, 64)                               \
+    }
+// Indexed by ISA level and the positions of N and K in smallSizes
+static const SmallKernel smallKernels[4][SmallSizes][SmallSizes] = {
+    SMALL_TABLE(smallScalar), SMALL_TABLE(smallSse4), SMALL_TABLE(smallAvx2),
+    SMALL_TABLE(smallAvx512)};
+#undef SMALL_TABLE
+#undef SMALL_ROW
+
+// Index of `d` among the specialized sizes, SmallSizes if it is not one
+size_t smallIndex(size_t d) {
+    for (size_t i = 0; i < SmallSizes; ++i)
+        if (d == smallSizes[i])
+            return i;
+    return SmallSizes;
+}
+
+// sgemm() on a B of float or 16-bit storage; `widen` converts the latter
+template <typename TB>
+void gemm(CpuIsa isa, bool transA, bool transB, size_t m, size_t n, size_t k,
+          const float *A, size_t lda, const TB *B, WidenFn widen, size_t ldb,
+          float *C, size_t ldc) {
+    if (m == 0 || n == 0)
+        return;
+    if (k == 0) {
+        for (size_t i = 0; i < m; ++i)
+            std::fill(C + i * ldc, C + i * ldc + n, 0.f);
+        return;
+    }
+    // Small fixed shapes: one unrolled pass, no blocking. B is copied into
+    // the contiguous K x N layout the kernel expects unless it already is.
+    if (size_t ni = smallIndex(n), ki = smallIndex(k);
+        m <= SmallMaxM && ni < SmallSizes && ki < SmallSizes) {
+        alignas(64) float packed[64 * 64];
+        const float *b = packed;
+        if constexpr (std::is_same_v<TB, float>) {
+            if (!transB && ldb == n)
+                b = B;
+            else
+                for (size_t p = 0; p < k; ++p)
+                    for (size_t j = 0; j < n; ++j)
+                        packed[p * n + j] =
+                            transB ? B[j * ldb + p] : B[p * ldb + j];
+        } else {
+            packB(transB, B, widen, ldb, 0, k, 0, n, n, packed);
+        }
+        smallKernels[static_cast<int>(isa)][ni][ki](
+            m, A, transA ? 1 : lda, transA ? lda : 1, b, C, ldc);
+        return;
+    }
+
+    auto micro = selectMicro(isa);
+    size_t mr = micro.mr, nr = micro.nr;
+    // Reused across calls on the same thread
+    thread_local vector<float> packedA, packedB;
+    size_t mcMax = std::min(MC, (m + mr - 1) / mr * mr);
+    size_t ncMax = std::min(NC, (n + nr - 1) / nr * nr);
+    size_t kcMax = std::min(KC, k);
+    packedA.resize(mcMax * kcMax);
+    packedB.resize(kcMax * ncMax);
+    float edge[8 * 32];
+
+    for (size_t jc = 0; jc < n; jc += NC) {
+        size_t nc = std::min(NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += KC) {
+            size_t kc = std::min(KC, k - pc);
+            bool accumulate = pc > 0;
+            if constexpr (std::is_same_v<TB, float>)
+                packB(transB, B, ldb, pc, kc, jc, nc, nr, packedB.data());
+            else
+                packB(transB, B, widen, ldb, pc, kc, jc, nc, nr,
+                      packedB.data());
+            for (size_t ic = 0; ic < m; ic += MC) {
+                size_t mc = std::min(MC, m - ic);
+                packA(transA, A, lda, ic, mc, pc, kc, mr, packedA.data());
+                for (size_t jr = 0; jr < nc; jr += nr) {
+                    size_t cols = std::min(nr, nc - jr);
+                    const float *b = packedB.data() + jr * kc;
+                    for (size_t ir = 0; ir < mc; ir += mr) {
+                        size_t rows = std::min(mr, mc - ir);
+                        const float *a = packedA.data() + ir * kc;
+                        float *c = C + (ic + ir) * ldc + jc + jr;
+                        if (rows == mr && cols == nr) {
+                            micro.fn(kc, a, b, c, ldc, accumulate);
+                            continue;
+                        }
+                        // Partial tiles go through a full-size scratch tile
+                        micro.fn(kc, a, b, edge, nr, false);
+                        for (size_t r = 0; r < rows; ++r)
+                            for (size_t j = 0; j < cols; ++j)
+                                c[r * ldc + j] = accumulate
+                                                     ? c[r * ldc + j] +
+                                                           edge[r * nr + j]
+                                                     : edge[r * nr + j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+void sgemv(CpuIsa isa, bool transW, size_t n, size_t k, const float *x,
+           const float *W, size_t ldw, float *y) {
+    (transW ? gemvDots : gemvRows).get(isa)(n, k, x, W, ldw, y);
+}
+
+void sgemm(CpuIsa isa, bool transA, bool transB, size_t m, size_t n,
+           size_t k, const float *A, size_t lda, const float *B, size_t ldb,
+           float *C, size_t ldc) {
+    gemm(isa, transA, transB, m, n, k, A, lda, B, nullptr, ldb, C, ldc);
+}
+
+void sgemm(CpuIsa isa, bool transA, bool transB, size_t m, size_t n,
+           size_t k, const float *A, size_t lda, const uint16_t *B,
+           HalfType bType, size_t ldb, float *C, size_t ldc) {
+    gemm(isa, transA, transB, m, n, k, A, lda, B, selectWiden(isa, bType),
+         ldb, C, ldc);
+}
+
+void sgemv(CpuIsa isa, bool transW, size_t n, size_t k, const float *x,
+           const uint16_t *W, HalfType wType, size_t ldw, float *y) {
+    selectHalfGemv(isa, wType, transW)(n, k, x, W, ldw, y);
+}
+
+void widenHalf(CpuIsa isa, HalfType type, const uint16_t *src, float *dst,
+               size_t n) {
+    selectWiden(isa, type)(src, dst, n);
+}
+
+} // namespace infini
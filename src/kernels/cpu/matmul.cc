@@ -0,0 +1,200 @@
+#include "operators/matmul.h"
+#include "core/kernel.h"
+#include "core/thread_pool.h"
+#include "kernels/cpu/gemm.h"
+#include "utils/isa_dispatch.h"
+#include <type_traits>
+
+namespace infini {
+
+/**
+ * @brief Float32 MatMul on the packed, register-tiled sgemm().
+ *
+ * Leading batch dimensions broadcast as in inferShape(): every output batch
+ * reads its A and B matrices at a precomputed offset, so a broadcast operand
+ * is shared, never copied. The work is split into batch x row-tile tasks on
+ * the thread pool, so many small per-head GEMMs keep every thread busy just
+ * like one large GEMM does.
+ *
+ * B may also be stored as Float16 or BFloat16 (A and C stay Float32): the
+ * weights are widened to fp32 as they are packed, or in registers on the
+ * GEMV path, and all accumulation is in fp32, so 16-bit weights halve the
+ * bytes a bandwidth-bound GEMV streams.
+ */
+class MatmulGemm : public CpuKernelWithoutConfig {
+    // Fewer rows per task would repack B more often than it pays off
+    static constexpr size_t MinTaskRows = 32;
+    // Output columns per GEMV task; a multiple of a cache line of floats
+    static constexpr size_t MinTaskCols = 64;
+
+    // Offset of the matrix of `t` used by each batch of `out`
+    static vector<size_t> batchOffsets(const Tensor &t, const Shape &out,
+                                       size_t matrixSize) {
+        auto dims = t->getDims();
+        int rank = out.size() - 2, tRank = dims.size() - 2;
+        vector<size_t> stride(rank, 0);
+        size_t s = matrixSize;
+        for (int i = tRank - 1; i >= 0; s *= dims[i--])
+            stride[i + rank - tRank] = dims[i] == 1 ? 0 : s;
+        size_t batch = 1;
+        for (int i = 0; i < rank; ++i)
+            batch *= out[i];
+        vector<size_t> offsets(batch);
+        for (size_t b = 0; b < batch; ++b) {
+            size_t rest = b;
+            for (int i = rank - 1; i >= 0; rest /= out[i--])
+                offsets[b] += rest % out[i] * stride[i];
+        }
+        return offsets;
+    }
+
+    // sgemm() and sgemv() on an fp32 or a 16-bit B under one name
+    static void gemm(CpuIsa isa, bool transA, bool transB, size_t m, size_t n,
+                     size_t k, const float *A, size_t lda, const float *B,
+                     HalfType, size_t ldb, float *C, size_t ldc) {
+        sgemm(isa, transA, transB, m, n, k, A, lda, B, ldb, C, ldc);
+    }
+    static void gemm(CpuIsa isa, bool transA, bool transB, size_t m, size_t n,
+                     size_t k, const float *A, size_t lda, const uint16_t *B,
+                     HalfType bType, size_t ldb, float *C, size_t ldc) {
+        sgemm(isa, transA, transB, m, n, k, A, lda, B, bType, ldb, C, ldc);
+    }
+    static void gemv(CpuIsa isa, bool transW, size_t n, size_t k,
+                     const float *x, const float *W, HalfType, size_t ldw,
+                     float *y) {
+        sgemv(isa, transW, n, k, x, W, ldw, y);
+    }
+    static void gemv(CpuIsa isa, bool transW, size_t n, size_t k,
+                     const float *x, const uint16_t *W, HalfType wType,
+                     size_t ldw, float *y) {
+        sgemv(isa, transW, n, k, x, W, wType, ldw, y);
+    }
+
+    /**
+     * A single row or column of output per batch is a GEMV over the other
+     * operand: y = a * op(B) for one row, y^T = b^T * op(A)^T for one
+     * column. Either way the vector operand x is contiguous (its only
+     * dimension besides k is 1) and W is read as stored, k x len or
+     * len x k when `transW`. Tasks are batch x column slices of y.
+     */
+    template <typename TW>
+    static void gemvTasks(const RuntimeObj *context, CpuIsa isa, size_t len,
+                          size_t k, size_t batch, const vector<size_t> &offX,
+                          const vector<size_t> &offW, const float *x,
+                          const TW *W, HalfType wType, size_t ldw,
+                          bool transW, float *c, size_t threads) {
+        size_t chunks = 1;
+        if (threads > 1 && batch < 2 * threads)
+            chunks = std::max<size_t>(
+                1, std::min((2 * threads + batch - 1) / batch,
+                            len / MinTaskCols));
+        size_t chunkCols = (len + chunks - 1) / chunks;
+        chunkCols = (chunkCols + 15) / 16 * 16;
+        chunks = (len + chunkCols - 1) / chunkCols;
+        parallelFor(context, batch * chunks, [&](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; ++task) {
+                size_t s = task / chunks, j0 = task % chunks * chunkCols;
+                size_t cols = std::min(chunkCols, len - j0);
+                const TW *w = W + offW[s] + (transW ? j0 * ldw : j0);
+                gemv(isa, transW, cols, k, x + offX[s], w, wType, ldw,
+                     c + s * len + j0);
+            }
+        });
+    }
+
+    /**
+     * C = A * B with B stored as TB: float, or uint16_t holding Float16 or
+     * BFloat16 (`bType`), which is widened to fp32 as it is packed.
+     */
+    template <typename TB>
+    static void multiply(const Ref<MatmulObj> &op, const RuntimeObj *context,
+                         const TB *b, HalfType bType) {
+        auto A = op->getInputs(0), B = op->getInputs(1), C = op->getOutput();
+        size_t m = op->getM(), n = op->getN(), k = op->getK();
+        bool transA = op->getTransA(), transB = op->getTransB();
+        auto offA = batchOffsets(A, C->getDims(), m * k);
+        auto offB = batchOffsets(B, C->getDims(), k * n);
+        size_t batch = offA.size();
+
+        // With B shared by all batches and the rows of A back to back, the
+        // whole batch is one tall GEMM and B is packed once per panel
+        bool fold = !transA && batch > 1;
+        for (size_t s = 0; fold && s < batch; ++s)
+            fold = offA[s] == s * m * k && offB[s] == 0;
+        size_t rows = m;
+        if (fold) {
+            rows *= batch;
+            batch = 1;
+        }
+
+        auto a = A->getRawDataPtr<float *>();
+        auto c = C->getRawDataPtr<float *>();
+        auto isa = getContextIsa(context);
+        size_t lda = transA ? m : k, ldb = transB ? k : n;
+        size_t threads = getParallelism(context);
+        if (rows == 1) {
+            gemvTasks(context, isa, n, k, batch, offA, offB, a, b, bType, ldb,
+                      transB, c, threads);
+            return;
+        }
+        if (n == 1) {
+            // B is the vector operand: widen it once, it is only k values
+            // per batch. op(A)^T is A itself stored the other way round.
+            if constexpr (std::is_same_v<TB, float>) {
+                gemvTasks(context, isa, rows, k, batch, offB, offA, b, a,
+                          bType, lda, !transA, c, threads);
+            } else {
+                vector<float> wide(B->size());
+                widenHalf(isa, bType, b, wide.data(), wide.size());
+                multiply(op, context, wide.data(), bType);
+            }
+            return;
+        }
+
+        // Whole matrices per task when there are enough batches, otherwise
+        // about two row tiles per thread
+        size_t tiles = 1;
+        if (threads > 1 && batch < 2 * threads)
+            tiles = std::max<size_t>(
+                1, std::min((2 * threads + batch - 1) / batch,
+                            rows / MinTaskRows));
+        size_t tileRows = (rows + tiles - 1) / tiles;
+        tiles = (rows + tileRows - 1) / tileRows;
+        parallelFor(context, batch * tiles, [&](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; ++task) {
+                size_t s = task / tiles, i0 = task % tiles * tileRows;
+                size_t mt = std::min(tileRows, rows - i0);
+                // Rows of op(A) start at row i0, or at column i0 if transposed
+                const float *aTile =
+                    a + offA[s] + (transA ? i0 : i0 * lda);
+                gemm(isa, transA, transB, mt, n, k, aTile, lda, b + offB[s],
+                     bType, ldb, c + s * m * n + i0 * n, n);
+            }
+        });
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<MatmulObj>(_op);
+        auto B = op->getInputs(1);
+        if (op->getOutput()->size() == 0)
+            return;
+        auto bType = B->getDType();
+        if (bType == DataType::Float32)
+            multiply(op, context, B->getRawDataPtr<float *>(),
+                     HalfType::Float16);
+        else if (bType == DataType::Float16)
+            multiply(op, context, B->getRawDataPtr<uint16_t *>(),
+                     HalfType::Float16);
+        else if (bType == DataType::BFloat16)
+            multiply(op, context, B->getRawDataPtr<uint16_t *>(),
+                     HalfType::BFloat16);
+        else
+            IT_TODO_HALT_MSG("MatMul weights of type " + bType.toString());
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::MatMul, DataType::Float32, MatmulGemm,
+                "matmulGemm_CPU");
+
+} // namespace infini
@@ -0,0 +1,452 @@
+#include "operators/quantized_matmul.h"
+#include "core/blob.h"
+#include "core/kernel.h"
+#include "core/thread_pool.h"
+#include "utils/isa_dispatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IT_TARGET_AVX512_VNNI                                                  \
+    __attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni,avx2,fma")))
+#endif
+
+namespace infini {
+
+namespace {
+
+// Output columns per packed panel of B, and rows per micro-kernel call
+constexpr size_t NR = 16;
+constexpr size_t MaxMR = 8;
+
+/**
+ * B packed in panels of NR columns. Within a panel, K is split into quads
+ * of 4 rows and quad q stores, for each column j, the 4 bytes
+ * B[4q .. 4q + 3][j] (zero past K or N): the operand layout of VNNI's
+ * vpdpbusd and, once widened, of pmaddwd.
+ */
+struct PackedB {
+    size_t quads = 0;
+    vector<int8_t> data;    // panels x quads x NR x 4
+    vector<int32_t> colSums; // Sum over K of each column
+};
+
+void packB(const int8_t *B, size_t k, size_t n, PackedB &out,
+           const RuntimeObj *context) {
+    size_t panels = (n + NR - 1) / NR;
+    out.quads = (k + 3) / 4;
+    out.data.assign(panels * out.quads * NR * 4, 0);
+    out.colSums.assign(panels * NR, 0);
+    parallelFor(context, panels, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) {
+            int8_t *panel = out.data.data() + s * out.quads * NR * 4;
+            int32_t *sums = out.colSums.data() + s * NR;
+            size_t cols = std::min(NR, n - s * NR);
+            for (size_t p = 0; p < k; ++p) {
+                const int8_t *src = B + p * n + s * NR;
+                int8_t *dst = panel + p / 4 * NR * 4 + p % 4;
+                for (size_t j = 0; j < cols; ++j) {
+                    dst[j * 4] = src[j];
+                    sums[j] += src[j];
+                }
+            }
+        }
+    });
+}
+
+// Position-dependent hash of `bytes` bytes, one pass that vectorizes
+uint64_t checksum(const int8_t *data, size_t bytes) {
+    constexpr uint64_t Mix = 0x9e3779b97f4a7c15;
+    uint64_t h = bytes;
+    size_t words = bytes / 8;
+#pragma omp simd reduction(+ : h)
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t w;
+        std::memcpy(&w, data + i * 8, 8);
+        h += (w ^ i) * Mix;
+    }
+    for (size_t i = words * 8; i < bytes; ++i)
+        h += (uint64_t(uint8_t(data[i])) ^ (i << 8)) * Mix;
+    return h;
+}
+
+/**
+ * Packed weights reused across runs, for weights no operator of the graph
+ * computes. An entry is keyed by the guid of the weight tensor and valid
+ * while the tensor keeps its blob, shape and contents: a checksum of B taken
+ * on every lookup catches writes that did not bump the version, at the cost
+ * of one read of B. Entries whose blob was released are dropped on the next
+ * lookup, and least recently used ones beyond MaxBytes; one still in use
+ * stays alive through its shared_ptr.
+ */
+class PackedBCache {
+    static constexpr size_t MaxBytes = size_t(256) << 20;
+    struct Entry {
+        UidBaseType guid;
+        std::weak_ptr<BlobObj> blob;
+        uint64_t checksum;
+        size_t k, n;
+        std::shared_ptr<const PackedB> packed;
+    };
+    std::mutex mtx;
+    std::list<Entry> lru; // Most recent first
+    std::unordered_map<UidBaseType, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+
+    static size_t sizeOf(const PackedB &p) {
+        return p.data.size() + p.colSums.size() * sizeof(int32_t);
+    }
+
+    void erase(std::list<Entry>::iterator it) {
+        bytes -= sizeOf(*it->packed);
+        index.erase(it->guid);
+        lru.erase(it);
+    }
+
+  public:
+    std::shared_ptr<const PackedB> get(const Tensor &B,
+                                       const RuntimeObj *context) {
+        size_t k = B->getDims()[0], n = B->getDims()[1];
+        auto data = B->getRawDataPtr<int8_t *>();
+        if (B->getSource()) {
+            // Computed by the graph, so likely different on every run
+            auto packed = std::make_shared<PackedB>();
+            packB(data, k, n, *packed, context);
+            return packed;
+        }
+        auto blob = B->getDataBlob();
+        auto sum = checksum(data, k * n);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto it = lru.begin(); it != lru.end();)
+                if ((it++)->blob.expired())
+                    erase(std::prev(it));
+            if (auto it = index.find(B->getGuid()); it != index.end()) {
+                auto &e = *it->second;
+                if (e.blob.lock() == blob && e.checksum == sum && e.k == k &&
+                    e.n == n) {
+                    lru.splice(lru.begin(), lru, it->second);
+                    return e.packed;
+                }
+                erase(it->second);
+            }
+        }
+        auto packed = std::make_shared<PackedB>();
+        packB(data, k, n, *packed, context);
+        std::lock_guard<std::mutex> lock(mtx);
+        if (auto it = index.find(B->getGuid()); it != index.end())
+            erase(it->second); // Packed concurrently
+        lru.push_front({B->getGuid(), blob, sum, k, n, packed});
+        index[B->getGuid()] = lru.begin();
+        bytes += sizeOf(*packed);
+        while (bytes > MaxBytes && lru.size() > 1)
+            erase(std::prev(lru.end()));
+        return packed;
+    }
+};
+
+// acc[r * NR + j] = sum_p A[r][p] * B[p][j] for `rows` rows of A and one
+// panel of B. `a` holds the rows in the layout the kernel expects, `rowBytes`
+// apart; see packRows().
+using QMicroKernel = void (*)(size_t rows, size_t quads, const void *a,
+                              size_t rowBytes, const int8_t *b, int32_t *acc);
+
+// Rows of A widened to int16 (scalar and AVX2 kernels)
+static void qmicroScalar(size_t rows, size_t quads, const void *a,
+                         size_t rowBytes, const int8_t *b, int32_t *acc) {
+    for (size_t r = 0; r < rows; ++r) {
+        auto ar = reinterpret_cast<const int16_t *>(
+            static_cast<const char *>(a) + r * rowBytes);
+        int32_t sum[NR] = {};
+        for (size_t q = 0; q < quads; ++q)
+            for (size_t j = 0; j < NR; ++j)
+                for (size_t t = 0; t < 4; ++t)
+                    sum[j] += ar[q * 4 + t] * b[(q * NR + j) * 4 + t];
+        std::copy(sum, sum + NR, acc + r * NR);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// pmaddwd on int16 pairs, exact where pmaddubsw would saturate. Accumulator
+// c of a row holds columns 4c .. 4c + 3 as pairs of partial sums, which are
+// added horizontally once at the end.
+IT_TARGET_AVX2 static void qmicroAvx2(size_t rows, size_t quads,
+                                      const void *a, size_t rowBytes,
+                                      const int8_t *b, int32_t *acc) {
+    for (size_t r0 = 0; r0 < rows; r0 += 2) {
+        bool two = r0 + 1 < rows;
+        auto a0 = reinterpret_cast<const int16_t *>(
+            static_cast<const char *>(a) + r0 * rowBytes);
+        auto a1 = reinterpret_cast<const int16_t *>(
+            reinterpret_cast<const char *>(a0) + (two ? rowBytes : 0));
+        __m256i s[2][4];
+        for (auto &row : s)
+            for (auto &v : row)
+                v = _mm256_setzero_si256();
+        for (size_t q = 0; q < quads; ++q) {
+            int64_t x0, x1;
+            std::memcpy(&x0, a0 + q * 4, 8);
+            std::memcpy(&x1, a1 + q * 4, 8);
+            __m256i av0 = _mm256_set1_epi64x(x0), av1 = _mm256_set1_epi64x(x1);
+            const int8_t *bq = b + q * NR * 4;
+#pragma GCC unroll 4
+            for (int c = 0; c < 4; ++c) {
+                __m256i bv = _mm256_cvtepi8_epi16(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(bq + c * 16)));
+                s[0][c] = _mm256_add_epi32(s[0][c], _mm256_madd_epi16(av0, bv));
+                s[1][c] = _mm256_add_epi32(s[1][c], _mm256_madd_epi16(av1, bv));
+            }
+        }
+        for (int r = 0; r < (two ? 2 : 1); ++r)
+            for (int c = 0; c < 4; c += 2) {
+                // Lane-wise hadd gives columns (0 1 4 5 | 2 3 6 7) of the 8
+                __m256i h = _mm256_hadd_epi32(s[r][c], s[r][c + 1]);
+                h = _mm256_permute4x64_epi64(h, _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i *>(acc + (r0 + r) * NR + c * 4),
+                    h);
+            }
+    }
+}
+
+// vpdpbusd multiplies unsigned by signed bytes: rows of A are stored with
+// 128 added (as uint8), which the caller takes back out with the column sums.
+// Two accumulators per row, for even and odd quads, halve the dependency
+// chains when there are few rows.
+template <size_t R>
+IT_TARGET_AVX512_VNNI static IT_ALWAYS_INLINE void
+vnniStep(__m512i *s, const char *a, size_t rowBytes, const int8_t *b,
+         size_t q) {
+    __m512i bv = _mm512_loadu_si512(b + q * NR * 4);
+#pragma GCC unroll 8
+    for (size_t r = 0; r < R; ++r) {
+        int32_t x;
+        std::memcpy(&x, a + r * rowBytes + q * 4, 4);
+        s[r] = _mm512_dpbusd_epi32(s[r], _mm512_set1_epi32(x), bv);
+    }
+}
+
+template <size_t R>
+IT_TARGET_AVX512_VNNI static IT_ALWAYS_INLINE void
+vnniRows(size_t quads, const char *a, size_t rowBytes, const int8_t *b,
+         int32_t *acc) {
+    __m512i even[R], odd[R];
+#pragma GCC unroll 8
+    for (size_t r = 0; r < R; ++r)
+        even[r] = odd[r] = _mm512_setzero_si512();
+    size_t q = 0;
+    for (; q + 2 <= quads; q += 2) {
+        vnniStep<R>(even, a, rowBytes, b, q);
+        vnniStep<R>(odd, a, rowBytes, b, q + 1);
+    }
+    if (q < quads)
+        vnniStep<R>(even, a, rowBytes, b, q);
+#pragma GCC unroll 8
+    for (size_t r = 0; r < R; ++r)
+        _mm512_storeu_si512(acc + r * NR, _mm512_add_epi32(even[r], odd[r]));
+}
+
+IT_TARGET_AVX512_VNNI static void qmicroVnni(size_t rows, size_t quads,
+                                             const void *a, size_t rowBytes,
+                                             const int8_t *b, int32_t *acc) {
+    auto base = static_cast<const char *>(a);
+    switch (rows) {
+#define CASE(R)                                                                \
+    case R:                                                                    \
+        return vnniRows<R>(quads, base, rowBytes, b, acc);
+        CASE(1) CASE(2) CASE(3) CASE(4) CASE(5) CASE(6) CASE(7) CASE(8)
+#undef CASE
+    }
+}
+#endif
+
+struct QMicro {
+    QMicroKernel fn;
+    bool vnni; // Rows of A as uint8 (+128) instead of int16
+};
+
+QMicro selectQMicro(CpuIsa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (isa >= CpuIsa::AVX512 && getCpuFeatures().avx512vnni)
+        return {qmicroVnni, true};
+    if (isa >= CpuIsa::AVX2)
+        return {qmicroAvx2, false};
+#endif
+    return {qmicroScalar, false};
+}
+
+// Copies `rows` rows of A (k bytes each) into `out`, padded to whole quads,
+// in the layout of the selected kernel, and stores their sums in `rowSums`
+void packRows(const int8_t *A, size_t rows, size_t k, size_t quads,
+              bool vnni, char *out, size_t rowBytes, int32_t *rowSums) {
+    for (size_t r = 0; r < rows; ++r, out += rowBytes) {
+        const int8_t *src = A + r * k;
+        int32_t sum = 0;
+        if (vnni) {
+            auto dst = reinterpret_cast<uint8_t *>(out);
+            for (size_t p = 0; p < k; ++p) {
+                dst[p] = uint8_t(src[p] + 128);
+                sum += src[p];
+            }
+            std::fill(dst + k, dst + quads * 4, uint8_t(128));
+        } else {
+            auto dst = reinterpret_cast<int16_t *>(out);
+            for (size_t p = 0; p < k; ++p) {
+                dst[p] = src[p];
+                sum += src[p];
+            }
+            std::fill(dst + k, dst + quads * 4, int16_t(0));
+        }
+        rowSums[r] = sum;
+    }
+}
+
+// Turns a row of integer dot products into dequantized or requantized outputs
+// The dot products reach 255 * 255 * K, past int32 above K = 33025, so the
+// terms added to the int32 accumulators are int64.
+struct Epilogue {
+    vector<int64_t> colTerm;
+    vector<int32_t> zeroB;
+    vector<float> colScale;
+    bool requantize = false;
+    float invScaleC = 1.f;
+    int32_t zeroC = 0;
+
+    // Outputs [j0, j0 + cols) of one row, written at out[offset ...]
+    void row(const int32_t *acc, size_t j0, size_t cols, int32_t rowSum,
+             void *out, size_t offset) const {
+        const int64_t *term = colTerm.data() + j0;
+        const int32_t *zb = zeroB.data() + j0;
+        const float *scale = colScale.data() + j0;
+        if (!requantize) {
+            float *y = static_cast<float *>(out) + offset;
+            for (size_t j = 0; j < cols; ++j)
+                y[j] = scale[j] * float(acc[j] + term[j] -
+                                        int64_t(zb[j]) * rowSum);
+            return;
+        }
+        int8_t *y = static_cast<int8_t *>(out) + offset;
+        for (size_t j = 0; j < cols; ++j) {
+            float v = scale[j] * float(acc[j] + term[j] -
+                                       int64_t(zb[j]) * rowSum);
+            v = std::clamp(v * invScaleC, -1e6f, 1e6f);
+            // Rounds half to even like lrint(), exact below 2^22
+            v = (v + 12582912.f) - 12582912.f + float(zeroC);
+            y[j] = int8_t(std::clamp(v, -128.f, 127.f));
+        }
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Int8 x int8 MatMul with int32 accumulation.
+ *
+ * With activations a = sA (qa - zA) and weights w = sB[j] (qb - zB[j]), each
+ * output is sA sB[j] (sum qa qb - zB[j] sum qa - zA sum qb + K zA zB[j]):
+ * the integer kernel computes sum qa qb, the row and column sums come from
+ * packing, and the rest is a per-element epilogue that dequantizes or
+ * requantizes. B is packed once and cached across runs, as weights rarely
+ * change. The micro-kernel uses AVX-512 VNNI when the host has it, pmaddwd
+ * on AVX2, and plain loops otherwise. All batches of A share B, so
+ * they form one tall product split into row blocks across the thread pool.
+ */
+class QuantizedMatmulCpu : public CpuKernelWithoutConfig {
+    // Fewer rows per task would not amortize a pass over packed B
+    static constexpr size_t MinTaskRows = 32;
+    // Packed rows of A a task works on at once, kept in L2 while every
+    // panel of B passes over them
+    static constexpr size_t ChunkBytes = 128 << 10;
+    mutable PackedBCache packedWeights;
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<QuantizedMatmulObj>(_op);
+        auto C = op->getOutput();
+        size_t n = op->getN(), k = op->getK();
+        size_t rows = n ? C->size() / n : 0;
+        if (rows == 0 || n == 0)
+            return;
+        // The accumulators of the kernel, |sum (qa + 128) qb| <= 255 * 128 K,
+        // stay below 2^31
+        IT_ASSERT(k <= (size_t(1) << 16),
+                  "QuantizedMatmul supports K up to 65536");
+        auto A = op->getInputs(0)->getRawDataPtr<int8_t *>();
+        auto scaleB = op->getInputs(2)->getRawDataPtr<float *>();
+        auto zeroB = op->getInputs(3)->getRawDataPtr<int8_t *>();
+        int32_t zeroA = op->getZeroA();
+
+        auto micro = selectQMicro(getContextIsa(context));
+        auto packedB = packedWeights.get(op->getInputs(1), context);
+        const PackedB &packed = *packedB;
+        size_t quads = packed.quads;
+        size_t rowBytes = quads * 4 * (micro.vnni ? 1 : sizeof(int16_t));
+
+        // Per column: dot = acc + colTerm[j] - zb[j] * rowSum, and the output
+        // is colScale[j] * dot before requantization
+        Epilogue epi;
+        epi.colTerm.resize(n);
+        epi.zeroB.assign(zeroB, zeroB + n);
+        epi.colScale.resize(n);
+        for (size_t j = 0; j < n; ++j) {
+            int64_t sum = packed.colSums[j];
+            epi.colTerm[j] = int64_t(k) * zeroA * zeroB[j] - zeroA * sum -
+                             (micro.vnni ? 128 * sum : 0);
+            epi.colScale[j] = op->getScaleA() * scaleB[j];
+        }
+        epi.requantize = op->getOutputType() == DataType::Int8;
+        epi.invScaleC = 1.f / op->getScaleC();
+        epi.zeroC = op->getZeroC();
+
+        size_t threads = getParallelism(context), tiles = 1;
+        if (threads > 1)
+            tiles = std::max<size_t>(
+                1, std::min(2 * threads, rows / MinTaskRows));
+        size_t tileRows = (rows + tiles - 1) / tiles;
+        tileRows = (tileRows + MaxMR - 1) / MaxMR * MaxMR;
+        tiles = (rows + tileRows - 1) / tileRows;
+        size_t chunkRows =
+            std::max<size_t>(1, ChunkBytes / rowBytes / MaxMR) * MaxMR;
+
+        void *out = C->getRawDataPtr<void *>();
+        parallelFor(context, tiles, [&](size_t begin, size_t end) {
+            thread_local vector<char> packedA;
+            thread_local vector<int32_t> rowSums;
+            int32_t acc[MaxMR * NR];
+            for (size_t tile = begin; tile < end; ++tile) {
+                size_t tileEnd = std::min(rows, (tile + 1) * tileRows);
+                for (size_t i0 = tile * tileRows; i0 < tileEnd;
+                     i0 += chunkRows) {
+                    size_t mc = std::min(chunkRows, tileEnd - i0);
+                    packedA.resize(mc * rowBytes);
+                    rowSums.resize(mc);
+                    packRows(A + i0 * k, mc, k, quads, micro.vnni,
+                             packedA.data(), rowBytes, rowSums.data());
+                    for (size_t j0 = 0; j0 < n; j0 += NR) {
+                        const int8_t *panel =
+                            packed.data.data() + j0 / NR * quads * NR * 4;
+                        size_t cols = std::min(NR, n - j0);
+                        for (size_t r0 = 0; r0 < mc; r0 += MaxMR) {
+                            size_t mr = std::min(MaxMR, mc - r0);
+                            micro.fn(mr, quads, packedA.data() + r0 * rowBytes,
+                                     rowBytes, panel, acc);
+                            for (size_t r = 0; r < mr; ++r)
+                                epi.row(acc + r * NR, j0, cols,
+                                        rowSums[r0 + r], out,
+                                        (i0 + r0 + r) * n + j0);
+                        }
+                    }
+                }
+            }
+        });
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::QuantizedMatMul, DataType::Int8,
+                QuantizedMatmulCpu, "quantizedMatmul_CPU");
+
+} // namespace infini
@@ -0,0 +1,235 @@
+#include "operators/sparse_matmul.h"
+#include "core/kernel.h"
+#include "core/thread_pool.h"
+#include "utils/isa_dispatch.h"
+#include <algorithm>
+#include <cstring>
+
+namespace infini {
+
+namespace {
+
+// Rows of A per pass over the blocks of an output group: every block loaded
+// is used Rows times
+constexpr size_t MaxRows = 8;
+
+// BN floats, the outputs of one input of a block
+template <size_t BN> struct BlockRow {
+    typedef float Vec __attribute__((vector_size(BN * sizeof(float))));
+};
+
+// sums[q] += the outputs of block `b` for row q of `a`
+template <size_t BK, size_t BN, size_t Rows>
+static IT_ALWAYS_INLINE void addBlock(const float *a, size_t lda,
+                                      const int32_t *colIndices,
+                                      const float *values, size_t b,
+                                      typename BlockRow<BN>::Vec *sums) {
+    const float *ab = a + size_t(colIndices[b]) * BK;
+    const float *v = values + b * BK * BN;
+#pragma GCC unroll 4
+    for (size_t r = 0; r < BK; ++r) {
+        typename BlockRow<BN>::Vec w;
+        std::memcpy(&w, v + r * BN, sizeof(w));
+#pragma GCC unroll 8
+        for (size_t q = 0; q < Rows; ++q)
+            sums[q] += ab[q * lda + r] * w;
+    }
+}
+
+/**
+ * Rows [i, i + Rows) of C, output groups [g0, g1), for blocks of BK inputs
+ * by BN outputs. The accumulators of a group are generic vectors of BN
+ * floats, so they stay in registers across the blocks. With fewer than four
+ * rows, consecutive blocks go to Chains independent accumulators per row, so
+ * the FMAs do not wait on each other.
+ */
+template <size_t BK, size_t BN, size_t Rows>
+static IT_ALWAYS_INLINE void spmmRows(size_t i, const float *A, size_t lda,
+                                      const int32_t *rowPtr,
+                                      const int32_t *colIndices,
+                                      const float *values, size_t g0,
+                                      size_t g1, float *C, size_t ldc) {
+    constexpr size_t Chains = Rows >= 4 ? 1 : 4;
+    const float *a = A + i * lda;
+    for (size_t g = g0; g < g1; ++g) {
+        typename BlockRow<BN>::Vec acc[Chains][Rows] = {};
+        size_t b = rowPtr[g], end = rowPtr[g + 1];
+        for (; b + Chains <= end; b += Chains)
+#pragma GCC unroll 4
+            for (size_t u = 0; u < Chains; ++u)
+                addBlock<BK, BN, Rows>(a, lda, colIndices, values, b + u,
+                                       acc[u]);
+        for (; b < end; ++b)
+            addBlock<BK, BN, Rows>(a, lda, colIndices, values, b, acc[0]);
+        for (size_t u = 1; u < Chains; ++u)
+            for (size_t q = 0; q < Rows; ++q)
+                acc[0][q] += acc[u][q];
+        for (size_t q = 0; q < Rows; ++q)
+            std::memcpy(C + (i + q) * ldc + g * BN, &acc[0][q],
+                        sizeof(acc[0][q]));
+    }
+}
+
+// CSR: one output per group, a dot product of a row of A gathered at the
+// stored inputs
+template <size_t Rows>
+static IT_ALWAYS_INLINE void csrRows(size_t i, const float *A, size_t lda,
+                                     const int32_t *rowPtr,
+                                     const int32_t *colIndices,
+                                     const float *values, size_t g0,
+                                     size_t g1, float *C, size_t ldc) {
+    const float *a = A + i * lda;
+    for (size_t g = g0; g < g1; ++g) {
+        float acc[Rows] = {};
+        int32_t begin = rowPtr[g], end = rowPtr[g + 1];
+        if constexpr (Rows == 1) {
+            float sum = 0;
+#pragma omp simd reduction(+ : sum)
+            for (int32_t b = begin; b < end; ++b)
+                sum += a[colIndices[b]] * values[b];
+            acc[0] = sum;
+        } else {
+            for (int32_t b = begin; b < end; ++b) {
+                const float *ab = a + colIndices[b];
+                float w = values[b];
+#pragma GCC unroll 8
+                for (size_t q = 0; q < Rows; ++q)
+                    acc[q] += ab[q * lda] * w;
+            }
+        }
+        for (size_t q = 0; q < Rows; ++q)
+            C[(i + q) * ldc + g] = acc[q];
+    }
+}
+
+template <size_t BK, size_t BN>
+static IT_ALWAYS_INLINE void spmmBody(size_t m, const float *A, size_t lda,
+                                      const int32_t *rowPtr,
+                                      const int32_t *colIndices,
+                                      const float *values, size_t g0,
+                                      size_t g1, float *C, size_t ldc) {
+    size_t i = 0;
+    if constexpr (BN == 1) {
+        for (; i + MaxRows <= m; i += MaxRows)
+            csrRows<MaxRows>(i, A, lda, rowPtr, colIndices, values, g0, g1, C,
+                             ldc);
+        for (; i < m; ++i)
+            csrRows<1>(i, A, lda, rowPtr, colIndices, values, g0, g1, C, ldc);
+    } else {
+        for (; i + MaxRows <= m; i += MaxRows)
+            spmmRows<BK, BN, MaxRows>(i, A, lda, rowPtr, colIndices, values,
+                                      g0, g1, C, ldc);
+        for (; i < m; ++i)
+            spmmRows<BK, BN, 1>(i, A, lda, rowPtr, colIndices, values, g0, g1,
+                                C, ldc);
+    }
+}
+
+static IT_ALWAYS_INLINE void csrBody(size_t m, const float *A, size_t lda,
+                                     const int32_t *rowPtr,
+                                     const int32_t *colIndices,
+                                     const float *values, size_t g0,
+                                     size_t g1, float *C, size_t ldc) {
+    spmmBody<1, 1>(m, A, lda, rowPtr, colIndices, values, g0, g1, C, ldc);
+}
+
+static IT_ALWAYS_INLINE void block4x4Body(size_t m, const float *A,
+                                          size_t lda, const int32_t *rowPtr,
+                                          const int32_t *colIndices,
+                                          const float *values, size_t g0,
+                                          size_t g1, float *C, size_t ldc) {
+    spmmBody<4, 4>(m, A, lda, rowPtr, colIndices, values, g0, g1, C, ldc);
+}
+
+static IT_ALWAYS_INLINE void block8x1Body(size_t m, const float *A,
+                                          size_t lda, const int32_t *rowPtr,
+                                          const int32_t *colIndices,
+                                          const float *values, size_t g0,
+                                          size_t g1, float *C, size_t ldc) {
+    spmmBody<1, 8>(m, A, lda, rowPtr, colIndices, values, g0, g1, C, ldc);
+}
+
+#define DEFINE_SPMM_VARIANTS(name, body)                                       \
+    IT_DEFINE_ISA_VARIANTS(                                                    \
+        name, body, void,                                                      \
+        (size_t m, const float *A, size_t lda, const int32_t *rowPtr,          \
+         const int32_t *colIndices, const float *values, size_t g0,            \
+         size_t g1, float *C, size_t ldc),                                     \
+        (m, A, lda, rowPtr, colIndices, values, g0, g1, C, ldc))
+DEFINE_SPMM_VARIANTS(spmmCsr, csrBody)
+DEFINE_SPMM_VARIANTS(spmmBlock4x4, block4x4Body)
+DEFINE_SPMM_VARIANTS(spmmBlock8x1, block8x1Body)
+#undef DEFINE_SPMM_VARIANTS
+
+} // namespace
+
+/**
+ * @brief SparseMatMul on the CPU. Only the stored blocks are visited: each
+ * output group accumulates its blocks in registers for up to eight rows of
+ * A at a time, and a group without blocks is written as zeros. Tasks are
+ * row tiles x ranges of output groups on the thread pool.
+ */
+class SparseMatmulCpu : public CpuKernelWithoutConfig {
+    // Rows per task; fewer would re-read the blocks more often than it pays
+    static constexpr size_t MinTaskRows = 32;
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<SparseMatmulObj>(_op);
+        auto C = op->getOutput();
+        size_t n = op->getN(), k = op->getK();
+        size_t rows = n ? C->size() / n : 0;
+        if (rows == 0)
+            return;
+        auto a = op->getInputs(0)->getRawDataPtr<float *>();
+        auto values = op->getInputs(1)->getRawDataPtr<float *>();
+        auto colIndices = op->getInputs(2)->getRawDataPtr<int32_t *>();
+        auto rowPtr = op->getInputs(3)->getRawDataPtr<int32_t *>();
+        auto c = C->getRawDataPtr<float *>();
+
+        auto format = op->getFormat();
+        size_t groups = n / sparseBlockN(format);
+        size_t blocks = op->getInputs(2)->size();
+        // Sorted from 0 to `blocks`, so every group's range is in bounds
+        IT_ASSERT(rowPtr[0] == 0 && size_t(rowPtr[groups]) == blocks &&
+                      std::is_sorted(rowPtr, rowPtr + groups + 1),
+                  "SparseMatmul rowPtr does not cover the blocks in order");
+        size_t inputBlocks = k / sparseBlockK(format);
+        IT_ASSERT(std::all_of(colIndices, colIndices + blocks,
+                              [&](int32_t b) {
+                                  return b >= 0 && size_t(b) < inputBlocks;
+                              }),
+                  "SparseMatmul block index out of range");
+        auto isa = getContextIsa(context);
+        auto spmm = format == SparseFormat::Block4x4   ? spmmBlock4x4.get(isa)
+                    : format == SparseFormat::Block8x1 ? spmmBlock8x1.get(isa)
+                                                       : spmmCsr.get(isa);
+
+        // About two tasks per thread: row tiles first, then output ranges
+        size_t threads = getParallelism(context);
+        size_t tiles = 1, ranges = 1;
+        if (threads > 1) {
+            tiles = std::max<size_t>(
+                1, std::min(2 * threads, rows / MinTaskRows));
+            ranges = std::min(groups, (2 * threads + tiles - 1) / tiles);
+        }
+        size_t tileRows = (rows + tiles - 1) / tiles;
+        tiles = (rows + tileRows - 1) / tileRows;
+        size_t rangeGroups = (groups + ranges - 1) / ranges;
+        ranges = (groups + rangeGroups - 1) / rangeGroups;
+        parallelFor(context, tiles * ranges, [&](size_t begin, size_t end) {
+            for (size_t task = begin; task < end; ++task) {
+                size_t i0 = task / ranges * tileRows;
+                size_t g0 = task % ranges * rangeGroups;
+                spmm(std::min(tileRows, rows - i0), a + i0 * k, k, rowPtr,
+                     colIndices, values, g0,
+                     std::min(groups, g0 + rangeGroups), c + i0 * n, n);
+            }
+        });
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::SparseMatMul, DataType::Float32,
+                SparseMatmulCpu, "sparseMatmul_CPU");
+
+} // namespace infini
@@ -1,18 +1,46 @@
 #include "operators/unary.h"
 #include "core/kernel.h"
+#include "utils/isa_dispatch.h"
+#include <limits>
 
 namespace infini
 {
+    static IT_ALWAYS_INLINE void reluBody(const float *x, float *y, size_t n)
+    {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+            y[i] = x[i] > 0.f ? x[i] : 0.f;
+    }
+
+    // lo/hi are -inf/+inf when the bound is absent; NaN passes through
+    static IT_ALWAYS_INLINE void clipBody(const float *x, float *y, size_t n,
+                                          float lo, float hi)
+    {
+#pragma omp simd
+        for (size_t i = 0; i < n; ++i)
+        {
+            float v = x[i] < lo ? lo : x[i];
+            y[i] = v > hi ? hi : v;
+        }
+    }
+
+    IT_DEFINE_ISA_VARIANTS(reluF32, reluBody, void,
+                           (const float *x, float *y, size_t n), (x, y, n))
+    IT_DEFINE_ISA_VARIANTS(clipF32, clipBody, void,
+                           (const float *x, float *y, size_t n, float lo,
+                            float hi),
+                           (x, y, n, lo, hi))
+
+    template <typename T>
     class NativeUnary : public CpuKernelWithoutConfig
     {
-        template <typename T>
         static T reluCompute(T val)
         {
             return std::max(T(0), val);
         }
 
-        template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
         {
             auto op = as<UnaryObj>(_op);
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
@@ -20,13 +48,18 @@ namespace infini
 
             auto outDim = op->getOutput()->getDims();
             auto n = op->getOutput()->size();
+            if constexpr (std::is_same_v<T, float>)
+            {
+                if (op->getOpType() == OpType::Relu)
+                    return reluF32.get(getContextIsa(context))(inptr, outptr, n);
+            }
 
             T (*_doCompute)
             (T val);
             switch (op->getOpType().underlying())
             {
             case OpType::Relu:
-                _doCompute = reluCompute<T>;
+                _doCompute = reluCompute;
                 break;
             default:
                 IT_TODO_HALT();
@@ -37,31 +70,13 @@ namespace infini
                 outptr[offset] = _doCompute(inptr[offset]);
             }
         }
-
-        void compute(const Operator &_op,
-                     const RuntimeObj *context) const override
-        {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
-        }
     };
 
+    template <typename T>
     class Clip : public CpuKernelWithoutConfig
     {
-        template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        void compute(const Operator &_op,
+                     const RuntimeObj *context) const override
         {
             auto op = as<ClipObj>(_op);
             T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
@@ -70,6 +85,13 @@ namespace infini
             auto maxValue = op->getMax();
 
             auto n = op->getOutput()->size();
+            if constexpr (std::is_same_v<T, float>)
+            {
+                constexpr float inf = std::numeric_limits<float>::infinity();
+                return clipF32.get(getContextIsa(context))(
+                    inptr, outptr, n, minValue.value_or(-inf),
+                    maxValue.value_or(inf));
+            }
             for (size_t offset = 0; offset < n; offset++)
             {
                 auto val = *inptr++;
@@ -78,28 +100,11 @@ namespace infini
                                                             : val;
             }
         }
-
-        void compute(const Operator &_op,
-                     const RuntimeObj *context) const override
-        {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
-        }
     };
 
-    REGISTER_KERNEL(Device::CPU, OpType::Relu, NativeUnary, "reluNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Clip, Clip, "Clip_CPU");
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Relu, NativeUnary,
+                          "reluNaive_CPU", 1 /* Float32 */, 12 /* UInt32 */);
+    REGISTER_KERNEL_TYPED(Device::CPU, OpType::Clip, Clip, "Clip_CPU",
+                          1 /* Float32 */, 12 /* UInt32 */);
 
 }; // namespace infini
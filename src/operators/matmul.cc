@@ -55,6 +55,10 @@ namespace infini
         outputShape.push_back(currentM);
         outputShape.push_back(currentN);
 
+        m = currentM;
+        n = currentN;
+        k = currnerK_A;
+
         return {{outputShape}};
     }
 
@@ -0,0 +1,64 @@
+#include "operators/quantized_matmul.h"
+
+namespace infini
+{
+
+    QuantizedMatmulObj::QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B,
+                                           Tensor scales, Tensor zeroPoints,
+                                           Tensor C, float scaleA, int zeroA,
+                                           DataType outputType, float scaleC,
+                                           int zeroC)
+        : OperatorObj(OpType::QuantizedMatMul,
+                      TensorVec{A, B, scales, zeroPoints}, {C}),
+          scaleA(scaleA), zeroA(zeroA), outputType(outputType),
+          scaleC(scaleC), zeroC(zeroC)
+    {
+        IT_ASSERT(outputType == DataType::Float32 ||
+                      outputType == DataType::Int8,
+                  "QuantizedMatmul outputs Float32 or Int8");
+        IT_ASSERT(zeroA >= -128 && zeroA <= 127 && zeroC >= -128 &&
+                  zeroC <= 127);
+        IT_ASSERT(checkValid(graph));
+    }
+
+    string QuantizedMatmulObj::toString() const
+    {
+        std::ostringstream os;
+        os << "QuantizedMatmul([A,B],A=" << inputs[0]->getGuid()
+           << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
+           << ",mnk=[" << m << "," << n << "," << k << "],out="
+           << outputType.toString() << ")";
+        return os.str();
+    }
+
+    optional<vector<Shape>>
+    QuantizedMatmulObj::inferShape(const TensorVec &inputs)
+    {
+        auto A = inputs[0], B = inputs[1];
+        auto scales = inputs[2], zeroPoints = inputs[3];
+        IT_ASSERT(A->getDType() == DataType::Int8 &&
+                  B->getDType() == DataType::Int8 &&
+                  scales->getDType() == DataType::Float32 &&
+                  zeroPoints->getDType() == DataType::Int8);
+
+        auto shapeA = A->getDims(), shapeB = B->getDims();
+        IT_ASSERT(shapeA.size() >= 2 && shapeB.size() == 2);
+        IT_ASSERT(shapeA.back() == shapeB[0]);
+        IT_ASSERT(scales->getDims() == Shape{shapeB[1]} &&
+                  zeroPoints->getDims() == Shape{shapeB[1]});
+
+        m = shapeA[shapeA.size() - 2];
+        n = shapeB[1];
+        k = shapeB[0];
+        Shape outputShape = shapeA;
+        outputShape.back() = n;
+        return {{outputShape}};
+    }
+
+    vector<DataType>
+    QuantizedMatmulObj::inferDataType(const TensorVec &inputs) const
+    {
+        return {outputType};
+    }
+
+} // namespace infini
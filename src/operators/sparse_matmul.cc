@@ -0,0 +1,86 @@
+#include "operators/sparse_matmul.h"
+
+namespace infini
+{
+
+    int sparseBlockK(SparseFormat format)
+    {
+        return format == SparseFormat::Block4x4 ? 4 : 1;
+    }
+
+    int sparseBlockN(SparseFormat format)
+    {
+        switch (format)
+        {
+        case SparseFormat::Block4x4:
+            return 4;
+        case SparseFormat::Block8x1:
+            return 8;
+        default:
+            return 1;
+        }
+    }
+
+    std::string sparseFormatToString(SparseFormat format)
+    {
+        switch (format)
+        {
+        case SparseFormat::Block4x4:
+            return "Block4x4";
+        case SparseFormat::Block8x1:
+            return "Block8x1";
+        default:
+            return "CSR";
+        }
+    }
+
+    SparseMatmulObj::SparseMatmulObj(GraphObj *graph, Tensor A, Tensor values,
+                                     Tensor colIndices, Tensor rowPtr,
+                                     Tensor C, SparseFormat format)
+        : OperatorObj(OpType::SparseMatMul,
+                      TensorVec{A, values, colIndices, rowPtr}, {C}),
+          format(format)
+    {
+        IT_ASSERT(checkValid(graph));
+    }
+
+    string SparseMatmulObj::toString() const
+    {
+        std::ostringstream os;
+        os << "SparseMatmul([A,B],A=" << inputs[0]->getGuid()
+           << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
+           << ",mnk=[" << m << "," << n << "," << k << "],format="
+           << sparseFormatToString(format)
+           << ",blocks=" << inputs[2]->size() << ")";
+        return os.str();
+    }
+
+    optional<vector<Shape>>
+    SparseMatmulObj::inferShape(const TensorVec &inputs)
+    {
+        auto A = inputs[0], values = inputs[1];
+        auto colIndices = inputs[2], rowPtr = inputs[3];
+        IT_ASSERT(A->getDType() == DataType::Float32 &&
+                  values->getDType() == DataType::Float32 &&
+                  colIndices->getDType() == DataType::Int32 &&
+                  rowPtr->getDType() == DataType::Int32);
+
+        int blockK = sparseBlockK(format), blockN = sparseBlockN(format);
+        auto shapeA = A->getDims();
+        IT_ASSERT(shapeA.size() >= 2 && shapeA.back() % blockK == 0,
+                  "SparseMatmul needs K to be a multiple of the block");
+        IT_ASSERT(values->getRank() == 3 &&
+                  values->getDims()[1] == blockK &&
+                  values->getDims()[2] == blockN);
+        IT_ASSERT(colIndices->getDims() == Shape{values->getDims()[0]});
+        IT_ASSERT(rowPtr->getRank() == 1 && rowPtr->getDims()[0] >= 1);
+
+        m = shapeA[shapeA.size() - 2];
+        k = shapeA.back();
+        n = (rowPtr->getDims()[0] - 1) * blockN;
+        Shape outputShape = shapeA;
+        outputShape.back() = n;
+        return {{outputShape}};
+    }
+
+} // namespace infini
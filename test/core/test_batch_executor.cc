@@ -0,0 +1,63 @@
+#include "core/batch_executor.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+
+#include "test.h"
+
+namespace infini {
+
+static BatchExecutor::Sample floatSample(const vector<float> &vals) {
+    vector<uint8_t> bytes(vals.size() * sizeof(float));
+    std::memcpy(bytes.data(), vals.data(), bytes.size());
+    return {bytes};
+}
+
+static vector<float> toFloats(const vector<uint8_t> &bytes) {
+    vector<float> vals(bytes.size() / sizeof(float));
+    std::memcpy(vals.data(), bytes.data(), bytes.size());
+    return vals;
+}
+
+TEST(BatchExecutor, Coalesce) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({4, 3}, DataType::Float32);
+    auto w = g->addTensor({3}, DataType::Float32);
+    g->addOp<AddObj>(x, w, nullptr);
+    g->dataMalloc();
+    w->setData(IncrementalGenerator());
+
+    BatchExecutor executor(g, {x}, 4, std::chrono::seconds(10));
+    vector<std::future<BatchExecutor::Sample>> results;
+    for (int i = 0; i < 4; ++i) {
+        float v = i * 10;
+        results.emplace_back(executor.submit(floatSample({v, v, v})));
+    }
+    for (int i = 0; i < 4; ++i) {
+        auto out = results[i].get();
+        ASSERT_EQ(out.size(), 1u);
+        float v = i * 10;
+        EXPECT_EQ(toFloats(out[0]), (vector<float>{v, v + 1, v + 2}));
+    }
+    EXPECT_EQ(executor.numBatches(), 1u);
+}
+
+TEST(BatchExecutor, Timeout) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({8, 2}, DataType::Float32);
+    auto w = g->addTensor({1, 2}, DataType::Float32);
+    g->addOp<MulObj>(x, w, nullptr);
+    g->dataMalloc();
+    w->setData(ValGenerator<2>());
+
+    BatchExecutor executor(g, {x}, 8, std::chrono::milliseconds(1));
+    // A lone request is flushed as a batch of one once the timeout expires.
+    auto out = executor.submit(floatSample({1, 3})).get();
+    EXPECT_EQ(toFloats(out[0]), (vector<float>{2, 6}));
+    EXPECT_EQ(x->getDims(), (Shape{1, 2}));
+    EXPECT_THROW(executor.submit(floatSample({1})), Exception);
+}
+
+} // namespace infini
@@ -0,0 +1,65 @@
+#include "core/cpu_info.h"
+#include "core/graph.h"
+#include "core/plan.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(CpuInfo, Detect) {
+    auto &f = getCpuFeatures();
+    auto isa = detectCpuIsa();
+    if (isa >= CpuIsa::AVX2) {
+        EXPECT_TRUE(f.avx2 && f.fma);
+    }
+    if (isa >= CpuIsa::AVX512) {
+        EXPECT_TRUE(f.avx512f && f.avx512vl);
+    }
+    EXPECT_EQ(isaFromString(isaToString(isa)), isa);
+    EXPECT_FALSE(isaFromString("avx1024").has_value());
+}
+
+TEST(CpuInfo, VariantsAgree) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    EXPECT_EQ(runtime->getIsa(), detectCpuIsa());
+
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({3, 37}, DataType::Float32);
+    auto b = g->addTensor({3, 37}, DataType::Float32);
+    auto sub = g->addOp<SubObj>(a, b, nullptr);
+    auto relu = g->addOp<ReluObj>(sub->getOutput(), nullptr);
+    auto clip = g->addOp<ClipObj>(sub->getOutput(), nullptr, -3.f, 40.f);
+    auto expRelu = g->addTensor({3, 37}, DataType::Float32);
+    auto expClip = g->addTensor({3, 37}, DataType::Float32);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(ValGenerator<5>());
+
+    auto refRelu = expRelu->getRawDataPtr<float *>();
+    auto refClip = expClip->getRawDataPtr<float *>();
+    for (int i = 0; i < 3 * 37; ++i) {
+        refRelu[i] = std::max(i - 5, 0);
+        refClip[i] = std::min(std::max(i - 5, -3), 40);
+    }
+
+    for (int level = static_cast<int>(detectCpuIsa()); level >= 0; --level) {
+        auto isa = static_cast<CpuIsa>(level);
+        runtime->setIsa(isa);
+        auto plan = runtime->compile(g);
+        EXPECT_EQ(plan->getIsa(), isa);
+        runtime->execute(plan);
+        EXPECT_TRUE(relu->getOutput()->equalData(expRelu)) << isaToString(isa);
+        EXPECT_TRUE(clip->getOutput()->equalData(expClip)) << isaToString(isa);
+    }
+    // A plan is bound to the ISA level it was compiled for
+    auto plan = runtime->compile(g);
+    if (detectCpuIsa() > CpuIsa::Scalar) {
+        runtime->setIsa(detectCpuIsa());
+        EXPECT_THROW(runtime->execute(plan), Exception);
+    }
+}
+
+} // namespace infini
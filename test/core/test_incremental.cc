@@ -0,0 +1,57 @@
+#include "core/graph.h"
+#include "core/incremental.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Incremental, FixedPrefixVaryingSuffix) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto context = g->addTensor({4}, DataType::Float32);
+    auto query = g->addTensor({4}, DataType::Float32);
+    // Prefix: three operators on the context only
+    auto c = g->addOp<ReluObj>(context, nullptr)->getOutput();
+    c = g->addOp<MulObj>(c, c, nullptr)->getOutput();
+    c = g->addOp<AddObj>(c, context, nullptr)->getOutput();
+    // Suffix: combines the prefix with the query
+    auto y = g->addOp<AddObj>(c, query, nullptr)->getOutput();
+    y = g->addOp<ReluObj>(y, nullptr)->getOutput();
+    g->dataMalloc();
+    context->setData(IncrementalGenerator());
+    query->setData(OneGenerator());
+
+    IncrementalExecutor executor(g);
+    EXPECT_EQ(executor.run(), 5u);
+    EXPECT_TRUE(y->equalData(vector<float>{1, 3, 7, 13}));
+    EXPECT_EQ(executor.run(), 0u);
+
+    // A new query only re-runs the suffix
+    query->setData(IncrementalGenerator());
+    EXPECT_EQ(executor.run(), 2u);
+    EXPECT_TRUE(y->equalData(vector<float>{0, 3, 8, 15}));
+
+    // Raw writes count once announced
+    context->getRawDataPtr<float *>()[0] = 2;
+    context->bumpVersion();
+    EXPECT_EQ(executor.run(), 5u);
+    EXPECT_TRUE(y->equalData(vector<float>{6, 3, 8, 15}));
+
+    executor.invalidate();
+    EXPECT_EQ(executor.run(), 5u);
+}
+
+TEST(Incremental, RejectsSharedBuffers) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({4}, DataType::Float32);
+    auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    g->dataMalloc();
+    y->setDataBlob(x->getDataBlob());
+    EXPECT_THROW(IncrementalExecutor{g}, Exception);
+}
+
+} // namespace infini
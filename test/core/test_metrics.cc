@@ -0,0 +1,85 @@
+#include "core/graph.h"
+#include "core/metrics.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+#include <cstdio>
+#include <fstream>
+
+namespace infini {
+
+TEST(Metrics, Counters) {
+    auto &metrics = Metrics::getInstance();
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 8}, DataType::Float32);
+    auto b = g->addTensor({2, 8}, DataType::Float32);
+    auto sum = g->addOp<AddObj>(a, b, nullptr)->getOutput();
+    g->addOp<ReluObj>(sum, nullptr);
+    // Compiled before dataMalloc: Add has several candidates but none can be
+    // timed yet
+    auto plan = runtime->compile(g);
+    metrics.reset();
+    g->dataMalloc();
+
+    runtime->execute(plan);
+    // Threads keep separate shards; the snapshot merges them
+    std::thread([&] { runtime->execute(plan); }).join();
+    runtime->execute(plan);
+
+    auto snap = metrics.snapshot();
+    EXPECT_EQ(snap.runs, 3u);
+    EXPECT_EQ(snap.ops.at("Add").calls, 3u);
+    EXPECT_EQ(snap.ops.at("Relu").calls, 3u);
+    EXPECT_EQ(snap.ops.count("MatMul"), 0u);
+    EXPECT_EQ(snap.fallbackHits, 3u);
+    EXPECT_EQ(snap.bytesPlanned, 4u * 2 * 8 * sizeof(float));
+    uint64_t histogram = 0;
+    for (auto n : snap.runLatency)
+        histogram += n;
+    EXPECT_EQ(histogram, 3u);
+
+    auto text = snap.toPrometheus();
+    EXPECT_NE(text.find("infini_runs_total 3\n"), string::npos);
+    EXPECT_NE(text.find("infini_op_calls_total{op=\"Relu\"} 3\n"),
+              string::npos);
+    EXPECT_NE(text.find("infini_run_latency_seconds_bucket{le=\"+Inf\"} 3\n"),
+              string::npos);
+    EXPECT_NE(snap.toJson().find("\"Add\": {\"calls\": 3"), string::npos);
+
+    metrics.setEnabled(false);
+    runtime->execute(plan);
+    metrics.setEnabled(true);
+    EXPECT_EQ(metrics.snapshot().runs, 3u);
+}
+
+TEST(Metrics, Exporter) {
+    string path = testing::TempDir() + "infini_metrics_export.prom";
+    std::remove(path.c_str());
+    {
+        MetricsExporter exporter(path, MetricsExporter::Format::Prometheus,
+                                 std::chrono::milliseconds(5));
+    }
+    std::ifstream ifs(path);
+    ASSERT_TRUE(ifs.good());
+    string first;
+    std::getline(ifs, first);
+    EXPECT_EQ(first, "# HELP infini_runs_total Graph runs executed.");
+    std::remove(path.c_str());
+
+    // Failed writes are reported, only the explicit one throws
+    string bad = testing::TempDir() + "missing-dir/metrics.prom";
+    testing::internal::CaptureStderr();
+    {
+        MetricsExporter exporter(bad, MetricsExporter::Format::Json,
+                                 std::chrono::milliseconds(5));
+        EXPECT_THROW(exporter.write(), Exception);
+    }
+    EXPECT_NE(testing::internal::GetCapturedStderr().find(
+                  "Cannot write metrics file"),
+              string::npos);
+}
+
+} // namespace infini
@@ -0,0 +1,70 @@
+#include "core/graph.h"
+#include "core/out_of_core.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// 4 KiB per tensor; `a` is read by the second and the last operator, and
+// step 3 holds a, b, c and d at once.
+static Graph buildChain(Runtime runtime, Tensor &a) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1024}, DataType::Float32);
+    a = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    auto b = g->addOp<ReluObj>(a, nullptr)->getOutput();
+    auto c = g->addOp<ReluObj>(b, nullptr)->getOutput();
+    auto t = g->addOp<AddObj>(b, c, nullptr)->getOutput();
+    for (int i = 0; i < 3; ++i)
+        t = g->addOp<ReluObj>(t, nullptr)->getOutput();
+    g->addOp<AddObj>(t, a, nullptr);
+    return g;
+}
+
+TEST(OutOfCore, SpillsUnderBudget) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Tensor a;
+    Graph g = buildChain(runtime, a);
+    auto x = g->getInputs()[0];
+
+    vector<float> result;
+    {
+        OutOfCoreExecutor executor(g, 20 * 1024);
+        x->setData(IncrementalGenerator());
+        executor.run();
+        EXPECT_EQ(executor.getSpilled(), TensorVec{a});
+        EXPECT_EQ(executor.getPlannedPeakBytes(), 20u * 1024);
+        EXPECT_LE(executor.getPeakBytes(), 20u * 1024);
+        EXPECT_FALSE(a->hasData());
+        auto out = g->getOutputs()[0]->getRawDataPtr<float *>();
+        result.assign(out, out + 1024);
+    }
+
+    Tensor ref;
+    Graph expected = buildChain(runtime, ref);
+    expected->dataMalloc();
+    expected->getInputs()[0]->setData(IncrementalGenerator());
+    runtime->run(expected);
+    EXPECT_TRUE(expected->getOutputs()[0]->equalData(result));
+}
+
+TEST(OutOfCore, NoSpillWhenFitting) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Tensor a;
+    Graph g = buildChain(runtime, a);
+    OutOfCoreExecutor executor(g, 1 << 20);
+    EXPECT_TRUE(executor.getSpilled().empty());
+    EXPECT_EQ(executor.getPlannedPeakBytes(), 24u * 1024);
+}
+
+TEST(OutOfCore, BudgetTooSmall) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Tensor a;
+    Graph g = buildChain(runtime, a);
+    // Step 3 needs b, c and d besides the pinned input and output
+    EXPECT_THROW(OutOfCoreExecutor(g, 16 * 1024), Exception);
+}
+
+} // namespace infini
@@ -0,0 +1,88 @@
+#include "core/graph.h"
+#include "core/pipeline_executor.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+static PipelineExecutor::Sample floatSample(const vector<float> &vals) {
+    vector<uint8_t> bytes(vals.size() * sizeof(float));
+    std::memcpy(bytes.data(), vals.data(), bytes.size());
+    return {bytes};
+}
+
+static vector<float> toFloats(const vector<uint8_t> &bytes) {
+    vector<float> vals(bytes.size() / sizeof(float));
+    std::memcpy(vals.data(), bytes.data(), bytes.size());
+    return vals;
+}
+
+TEST(PipelineExecutor, Chain) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3}, DataType::Float32);
+    auto w = g->addTensor({3}, DataType::Float32);
+    // relu(x), then three times (t + w) * w, then relu: eight operators
+    auto t = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    for (int i = 0; i < 3; ++i) {
+        t = g->addOp<AddObj>(t, w, nullptr)->getOutput();
+        t = g->addOp<MulObj>(t, w, nullptr)->getOutput();
+    }
+    g->addOp<ReluObj>(t, nullptr);
+    g->dataMalloc();
+    w->setData(IncrementalGenerator());
+
+    PipelineExecutor executor(g, {x}, 3, 2, {{0}, {0}, {0}});
+    auto bounds = executor.getStageBounds();
+    ASSERT_EQ(bounds.size(), 3u);
+    EXPECT_EQ(bounds.front().first, 0u);
+    EXPECT_EQ(bounds.back().second, g->getOperators().size());
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        EXPECT_LT(bounds[i].first, bounds[i].second);
+        if (i > 0) {
+            EXPECT_EQ(bounds[i].first, bounds[i - 1].second);
+        }
+    }
+
+    auto reference = [](float v, int col) {
+        float r = std::max(v, 0.f);
+        for (int i = 0; i < 3; ++i)
+            r = (r + col) * col;
+        return std::max(r, 0.f);
+    };
+    vector<std::future<PipelineExecutor::Sample>> results;
+    for (int i = 0; i < 16; ++i) {
+        float v = i - 4;
+        results.emplace_back(
+            executor.submit(floatSample({v, v, v, -v, -v, -v})));
+    }
+    for (int i = 0; i < 16; ++i) {
+        auto out = results[i].get();
+        ASSERT_EQ(out.size(), 1u);
+        float v = i - 4;
+        vector<float> expected;
+        for (int col = 0; col < 3; ++col)
+            expected.emplace_back(reference(v, col));
+        for (int col = 0; col < 3; ++col)
+            expected.emplace_back(reference(-v, col));
+        EXPECT_EQ(toFloats(out[0]), expected);
+    }
+    // The graph's own buffers are not touched by the pipeline
+    EXPECT_TRUE(x->hasData());
+    EXPECT_THROW(executor.submit(floatSample({1})), Exception);
+}
+
+TEST(PipelineExecutor, InvalidCpus) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({4}, DataType::Float32);
+    auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+    g->addOp<ReluObj>(y, nullptr);
+    EXPECT_THROW(PipelineExecutor(g, {x}, 3), Exception);
+    EXPECT_THROW(PipelineExecutor(g, {x}, 2, 2, {{0}, {-1}}), Exception);
+}
+
+} // namespace infini
@@ -0,0 +1,52 @@
+#include "core/graph.h"
+#include "core/plan_cache.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(PlanCache, SwitchShapes) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({1, 4}, DataType::Float32);
+    auto w = g->addTensor({4}, DataType::Float32);
+    // relu(relu(relu(x - w))) + w
+    auto t = g->addOp<SubObj>(x, w, nullptr)->getOutput();
+    for (int i = 0; i < 3; ++i)
+        t = g->addOp<ReluObj>(t, nullptr)->getOutput();
+    auto y = g->addOp<AddObj>(t, w, nullptr)->getOutput();
+    g->dataMalloc();
+    w->setData(ValGenerator<2>());
+
+    PlanCache cache(g, {x});
+    auto runWith = [&](int batch) {
+        auto plan = cache.activate({{batch, 4}});
+        x->setData(IncrementalGenerator());
+        runtime->execute(plan);
+        vector<float> expected;
+        for (int i = 0; i < batch * 4; ++i)
+            expected.emplace_back(std::max(i - 2, 0) + 2);
+        EXPECT_EQ(y->getDims(), (Shape{batch, 4}));
+        EXPECT_TRUE(y->equalData(expected));
+        return plan;
+    };
+    auto p8 = runWith(8);
+    // x, y and at most two intermediates of 8 x 4 floats are live at once
+    EXPECT_LE(cache.getActiveBytes(), 4u * 8 * 4 * sizeof(float));
+    auto p1 = runWith(1);
+    EXPECT_NE(p1, p8);
+    EXPECT_EQ(runWith(8), p8);
+    EXPECT_EQ(runWith(1), p1);
+    EXPECT_EQ(cache.numPlans(), 2u);
+
+    // Switching back restores the shapes and buffers of the earlier plan
+    cache.activate({{8, 4}});
+    EXPECT_EQ(y->getDims(), (Shape{8, 4}));
+    EXPECT_EQ(y->getRawDataPtr<float *>()[31], 31.f);
+    EXPECT_THROW(cache.activate({{8, 4}, {1}}), Exception);
+}
+
+} // namespace infini
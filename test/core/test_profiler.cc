@@ -0,0 +1,93 @@
+#include "core/graph.h"
+#include "core/profiler.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Profiler, PerOpRecords) {
+    for (bool useCounters : {true, false}) {
+        auto runtime = make_ref<NativeCpuRuntimeObj>();
+        auto profiler = make_ref<Profiler>(useCounters);
+        runtime->setProfiler(profiler);
+
+        Graph g = make_ref<GraphObj>(runtime);
+        auto a = g->addTensor({64, 64}, DataType::Float32);
+        auto b = g->addTensor({64, 64}, DataType::Float32);
+        auto add = g->addOp<AddObj>(a, b, nullptr);
+        auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+        g->dataMalloc();
+        a->setData(IncrementalGenerator());
+        b->setData(OneGenerator());
+
+        runtime->run(g);
+        runtime->run(g);
+        auto &records = profiler->getRecords();
+        ASSERT_EQ(records.size(), 2u);
+        EXPECT_EQ(records[0].guid, add->getGuid());
+        EXPECT_EQ(records[1].type, OpType::Relu);
+        EXPECT_EQ(records[1].kernelName, "reluNaive_CPU");
+        for (auto &r : records) {
+            EXPECT_EQ(r.calls, 2u);
+            EXPECT_GE(r.seconds, 0);
+            if (profiler->hasCounters()) {
+                EXPECT_GT(r.instructions, 0u);
+            } else {
+                EXPECT_EQ(r.cycles, 0u);
+            }
+        }
+        if (!useCounters) {
+            EXPECT_FALSE(profiler->hasCounters());
+        }
+        auto report = profiler->report();
+        EXPECT_NE(report.find("reluNaive_CPU"), string::npos);
+        EXPECT_NE(report.find("Total: "), string::npos);
+        EXPECT_EQ(report.find("Hardware counters unavailable") ==
+                      string::npos,
+                  profiler->hasCounters());
+
+        profiler->reset();
+        EXPECT_TRUE(profiler->getRecords().empty());
+    }
+}
+
+TEST(Profiler, Roofline) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    auto profiler = make_ref<Profiler>(false);
+    auto peaks = Profiler::calibrate();
+    EXPECT_GT(peaks.gflops, 0);
+    EXPECT_GT(peaks.gbps, 0);
+    profiler->setPeaks(peaks);
+    runtime->setProfiler(profiler);
+
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({256, 64}, DataType::Float32);
+    auto b = g->addTensor({64}, DataType::Float32);
+    auto mul = g->addOp<MulObj>(a, b, nullptr);
+    auto clip = g->addOp<ClipObj>(mul->getOutput(), nullptr, 0.f, std::nullopt);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(OneGenerator());
+    EXPECT_EQ(mul->getFlops(), 256u * 64);
+    EXPECT_EQ(mul->getBytesMoved(), (256u * 64 * 2 + 64) * sizeof(float));
+    EXPECT_EQ(clip->getFlops(), 256u * 64);
+
+    runtime->run(g);
+    auto &records = profiler->getRecords();
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].flops, mul->getFlops());
+    EXPECT_EQ(records[0].bytes, mul->getBytesMoved());
+    EXPECT_DOUBLE_EQ(records[0].intensity(),
+                     double(mul->getFlops()) / mul->getBytesMoved());
+    EXPECT_EQ(records[1].flops, clip->getFlops());
+    EXPECT_EQ(records[1].calls, 1u);
+    auto report = profiler->report();
+    EXPECT_NE(report.find("Machine peaks: "), string::npos);
+    EXPECT_NE(report.find("%Roof"), string::npos);
+    EXPECT_NE(report.find(records[0].kernelName), string::npos);
+}
+
+} // namespace infini
@@ -0,0 +1,66 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "core/scheduler.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// A chain of `n` Relu operators over `size` floats
+static Graph reluChain(Runtime runtime, int n, int size) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto t = g->addTensor({size}, DataType::Float32);
+    for (int i = 0; i < n; ++i)
+        t = g->addOp<ReluObj>(t, nullptr)->getOutput();
+    g->dataMalloc();
+    return g;
+}
+
+TEST(GraphScheduler, Preempt) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto batch = reluChain(runtime, 400, 1 << 16);
+    auto interactive = reluChain(runtime, 2, 16);
+    interactive->getInputs()[0]->setData(IncrementalGenerator());
+
+    GraphScheduler scheduler(runtime);
+    auto low = scheduler.submit(batch, 0);
+    while (scheduler.getStats().opsExecuted == 0)
+        std::this_thread::yield();
+    auto high = scheduler.submit(interactive, 1,
+                                 GraphScheduler::Clock::now() +
+                                     std::chrono::seconds(10));
+    high.get();
+    // The interactive request cut in between operators of the batch job
+    EXPECT_EQ(low.wait_for(std::chrono::seconds(0)),
+              std::future_status::timeout);
+    auto out = interactive->getOutputs()[0];
+    EXPECT_TRUE(out->equalData(interactive->getInputs()[0]));
+    low.get();
+
+    auto stats = scheduler.getStats();
+    EXPECT_EQ(stats.completed, 2u);
+    EXPECT_EQ(stats.opsExecuted, 402u);
+    EXPECT_GE(stats.preemptions, 1u);
+    EXPECT_EQ(stats.deadlineMisses, 0u);
+}
+
+TEST(GraphScheduler, Deadline) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto g = reluChain(runtime, 3, 16);
+    GraphScheduler scheduler(runtime);
+    auto expired = scheduler.submit(g, 0, GraphScheduler::Clock::now() -
+                                              std::chrono::seconds(1));
+    // Requests for the same graph run one after another
+    auto f1 = scheduler.submit(g);
+    auto f2 = scheduler.submit(g, 5);
+    EXPECT_THROW(expired.get(), Exception);
+    f1.get();
+    f2.get();
+    auto stats = scheduler.getStats();
+    EXPECT_EQ(stats.dropped, 1u);
+    EXPECT_EQ(stats.completed, 2u);
+    EXPECT_EQ(stats.opsExecuted, 6u);
+}
+
+} // namespace infini
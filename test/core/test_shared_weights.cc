@@ -0,0 +1,97 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "core/shared_weights.h"
+#include "operators/element_wise.h"
+
+#include "test.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace infini {
+
+TEST(SharedWeights, PublishAndAttach) {
+    string name = "/infini_test_weights_" + std::to_string(getpid());
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3}, DataType::Float32);
+    auto w = g->addTensor({2, 3}, DataType::Float32);
+    auto b = g->addTensor({3}, DataType::UInt32);
+    auto y = g->addOp<AddObj>(x, w, nullptr)->getOutput();
+    g->dataMalloc();
+    x->setData(OneGenerator());
+    w->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+
+    auto published = SharedWeights::publish(name, {w, b});
+    EXPECT_THROW(SharedWeights::publish(name, {w}), Exception);
+    // The publisher computes from the segment too
+    runtime->run(g);
+    EXPECT_TRUE(y->equalData(vector<float>{1, 2, 3, 4, 5, 6}));
+
+    // Another process maps the same pages
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        bool ok = false;
+        try {
+            auto w2 = make_ref<TensorObj>(Shape{2, 3}, DataType::Float32,
+                                          runtime);
+            auto b2 = make_ref<TensorObj>(Shape{3}, DataType::UInt32, runtime);
+            auto attached = SharedWeights::attach(name, {w2, b2});
+            ok = w2->equalData(vector<float>{0, 1, 2, 3, 4, 5}) &&
+                 b2->equalData(vector<uint32_t>{0, 1, 2});
+        } catch (...) {
+        }
+        _exit(ok ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    auto other = make_ref<TensorObj>(Shape{3, 2}, DataType::Float32, runtime);
+    auto b3 = make_ref<TensorObj>(Shape{3}, DataType::UInt32, runtime);
+    EXPECT_THROW(SharedWeights::attach(name, {other, b3}), Exception);
+    EXPECT_THROW(SharedWeights::attach(name, {b3}), Exception);
+
+    // Dropping the handle keeps the mapping while tensors use it
+    published.reset();
+    EXPECT_TRUE(w->equalData(vector<float>{0, 1, 2, 3, 4, 5}));
+    SharedWeights::remove(name);
+    EXPECT_THROW(SharedWeights::attach(name, {w, b}), Exception);
+}
+
+TEST(SharedWeights, RejectsTruncatedSegment) {
+    string name = "/infini_test_weights_" + std::to_string(getpid());
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto w = g->addTensor({4, 4}, DataType::Float32);
+    g->dataMalloc();
+    w->setData(IncrementalGenerator());
+    auto published = SharedWeights::publish(name, {w});
+
+    // Only the header and the table, which take the first 128 bytes, with
+    // the size in the header patched to match: the data lies past the end
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    ASSERT_GE(fd, 0);
+    vector<char> prefix(128);
+    ASSERT_EQ(pread(fd, prefix.data(), prefix.size(), 0),
+              (ssize_t)prefix.size());
+    close(fd);
+    uint64_t size = prefix.size();
+    std::memcpy(prefix.data() + 16, &size, sizeof(size));
+    string truncated = name + "_truncated";
+    fd = shm_open(truncated.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, prefix.data(), prefix.size()), (ssize_t)size);
+    close(fd);
+
+    auto w2 = make_ref<TensorObj>(Shape{4, 4}, DataType::Float32, runtime);
+    EXPECT_THROW(SharedWeights::attach(truncated, {w2}), Exception);
+    SharedWeights::remove(truncated);
+    SharedWeights::remove(name);
+}
+
+} // namespace infini
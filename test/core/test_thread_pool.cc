@@ -0,0 +1,141 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "core/thread_pool.h"
+
+#include "test.h"
+#include <atomic>
+#include <sched.h>
+
+namespace infini {
+
+TEST(ThreadPool, ParallelFor) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.getNumThreads(), 4);
+    vector<int> hits(1000, 0);
+    std::atomic<int> calls{0};
+    pool.parallelFor(hits.size(), [&](size_t begin, size_t end) {
+        calls++;
+        for (size_t i = begin; i < end; ++i)
+            hits[i]++;
+    });
+    EXPECT_EQ(calls.load(), 4);
+    EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), 1000);
+
+    // Small loops stay on the caller
+    calls = 0;
+    pool.parallelFor(10, [&](size_t, size_t) { calls++; }, 100);
+    EXPECT_EQ(calls.load(), 1);
+
+    // Nested loops run inline instead of waiting for the busy pool
+    std::atomic<int> inner{0};
+    pool.parallelFor(4, [&](size_t, size_t) {
+        pool.parallelFor(8, [&](size_t begin, size_t end) {
+            inner += end - begin;
+        });
+    });
+    EXPECT_EQ(inner.load(), 32);
+
+    EXPECT_THROW(pool.parallelFor(100,
+                                  [](size_t begin, size_t) {
+                                      IT_ASSERT(begin == 0);
+                                  }),
+                 Exception);
+}
+
+TEST(ThreadPool, WaitPolicies) {
+    using std::chrono::microseconds;
+    for (auto policy : {WaitPolicy::sleep(), WaitPolicy::spinThenPark(),
+                        WaitPolicy::spinThenPark(microseconds(0),
+                                                 microseconds(100)),
+                        WaitPolicy::hot()}) {
+        ThreadPool pool(3, {}, policy);
+        std::atomic<size_t> sum{0};
+        // Many back-to-back tiny jobs, with pauses long enough for the
+        // workers to park in between
+        for (int i = 0; i < 200; ++i) {
+            pool.parallelFor(30, [&](size_t begin, size_t end) {
+                sum += end - begin;
+            });
+            if (i % 50 == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        EXPECT_EQ(sum.load(), 200u * 30);
+        EXPECT_THROW(pool.parallelFor(3,
+                                      [](size_t begin, size_t) {
+                                          IT_ASSERT(begin != 2);
+                                      }),
+                     Exception);
+    }
+}
+
+TEST(ThreadPool, Partition) {
+    int cpu = getAvailableCpus().front();
+    {
+        auto a = make_ref<NativeCpuRuntimeObj>(CpuPartition::exclusive({cpu}));
+        EXPECT_EQ(a->getThreadPool().getNumThreads(), 1);
+        a->bindCurrentThread();
+        EXPECT_THROW(
+            make_ref<NativeCpuRuntimeObj>(CpuPartition::exclusive({cpu})),
+            Exception);
+        EXPECT_THROW(
+            make_ref<NativeCpuRuntimeObj>(CpuPartition::shared({cpu})),
+            Exception);
+    }
+    // Released with the runtime; shared partitions may overlap
+    auto b = make_ref<NativeCpuRuntimeObj>(CpuPartition::shared({cpu}, 1));
+    auto c = make_ref<NativeCpuRuntimeObj>(CpuPartition::shared({cpu}, 2));
+    EXPECT_EQ(b->getThreadPool().getNumThreads(), 1);
+    EXPECT_EQ(c->getThreadPool().getNumThreads(), 2);
+    EXPECT_THROW(make_ref<NativeCpuRuntimeObj>(CpuPartition::exclusive({cpu})),
+                 Exception);
+    EXPECT_THROW(make_ref<NativeCpuRuntimeObj>(CpuPartition::shared({100000})),
+                 Exception);
+    EXPECT_THROW(CpuPartition::shared({cpu, cpu}), Exception);
+    EXPECT_THROW(CpuPartition::exclusive({cpu, cpu}), Exception);
+    pinCurrentThread(getAvailableCpus());
+}
+
+// Union of the CPUs the workers of `runtime` may run on, as they see it
+static std::set<int> workerAffinity(const NativeCpuRuntimeObj &runtime) {
+    auto caller = std::this_thread::get_id();
+    std::mutex mtx;
+    std::set<int> cpus;
+    auto &pool = runtime.getThreadPool();
+    pool.parallelFor(pool.getNumThreads(), [&](size_t, size_t) {
+        if (std::this_thread::get_id() == caller)
+            return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        sched_getaffinity(0, sizeof(set), &set);
+        std::lock_guard<std::mutex> lock(mtx);
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            if (CPU_ISSET(cpu, &set))
+                cpus.insert(cpu);
+    });
+    return cpus;
+}
+
+TEST(ThreadPool, PartitionNextToDefaultRuntime) {
+    // The default runtime shares every CPU without claiming them
+    auto &instance = NativeCpuRuntimeObj::getInstance();
+    auto &available = getAvailableCpus();
+    int cpu = available.front();
+    {
+        auto a = make_ref<NativeCpuRuntimeObj>(CpuPartition::exclusive({cpu}));
+        EXPECT_EQ(a->getThreadPool().getNumThreads(), 1);
+        auto b = make_ref<NativeCpuRuntimeObj>();
+        EXPECT_EQ(b->getPartition().cpus, available);
+        // Its workers keep off the exclusive CPU while it is held
+        if (available.size() > 1) {
+            EXPECT_FALSE(workerAffinity(*instance).count(cpu));
+            EXPECT_FALSE(workerAffinity(*b).count(cpu));
+        }
+    }
+    if (available.size() > 1) {
+        EXPECT_TRUE(workerAffinity(*instance).count(cpu));
+    }
+    auto c = make_ref<NativeCpuRuntimeObj>(CpuPartition::exclusive({cpu}));
+    EXPECT_EQ(instance->getPartition().cpus, available);
+}
+
+} // namespace infini
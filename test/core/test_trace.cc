@@ -0,0 +1,69 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "core/trace.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Trace, RecordSaveLoadReplay) {
+    auto runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3}, DataType::Float32);
+    auto w = g->addTensor({3}, DataType::Float32);
+    auto t = g->addOp<AddObj>(x, w, nullptr)->getOutput();
+    t = g->addOp<ClipObj>(t, nullptr, 1.5f, std::nullopt)->getOutput();
+    t = g->addOp<TransposeObj>(t, nullptr, vector<int>{1, 0})->getOutput();
+    auto y = g->addOp<ConcatObj>(TensorVec{t, t}, nullptr, 1)->getOutput();
+    g->dataMalloc();
+    x->setData(IncrementalGenerator());
+    w->setData(OneGenerator());
+
+    auto trace = Trace::record(runtime, runtime->compile(g), true);
+    ASSERT_EQ(trace.steps.size(), 4u);
+    vector<float> expected{1.5, 4, 1.5, 4, 2, 5, 2, 5, 3, 6, 3, 6};
+    EXPECT_TRUE(y->equalData(expected));
+
+    string path = testing::TempDir() + "infini_trace.bin";
+    trace.save(path);
+    auto loaded = Trace::load(path);
+    ASSERT_EQ(loaded.tensors.size(), trace.tensors.size());
+    for (size_t i = 0; i < trace.tensors.size(); ++i) {
+        EXPECT_EQ(loaded.tensors[i].dims, trace.tensors[i].dims);
+        EXPECT_EQ(loaded.tensors[i].offset, trace.tensors[i].offset);
+        EXPECT_EQ(loaded.tensors[i].snapshot, trace.tensors[i].snapshot);
+    }
+    for (size_t i = 0; i < trace.steps.size(); ++i) {
+        EXPECT_EQ(loaded.steps[i].type, trace.steps[i].type);
+        EXPECT_EQ(loaded.steps[i].attrs, trace.steps[i].attrs);
+        EXPECT_EQ(loaded.steps[i].kernelName, trace.steps[i].kernelName);
+        EXPECT_EQ(loaded.steps[i].nanos, trace.steps[i].nanos);
+    }
+
+    // The whole trace, with another Add kernel, reproduces the output
+    ReplayOptions options;
+    options.kernels["Add"] = "addStrided_CPU";
+    options.repeat = 3;
+    auto result = replayTrace(loaded, runtime, options);
+    EXPECT_EQ(result.steps.size(), 4u);
+    EXPECT_EQ(result.kernelNames[0], "addStrided_CPU");
+    auto outputs = result.graph->getOutputs();
+    ASSERT_EQ(outputs.size(), 1u);
+    EXPECT_TRUE(outputs[0]->equalData(expected));
+
+    // One step alone
+    options.step = 3;
+    result = replayTrace(loaded, runtime, options);
+    EXPECT_EQ(result.steps, vector<size_t>{3});
+    EXPECT_TRUE(result.graph->getOutputs()[0]->equalData(expected));
+
+    options.kernels["Add"] = "noSuchKernel";
+    EXPECT_THROW(replayTrace(loaded, runtime, options), Exception);
+    std::remove(path.c_str());
+}
+
+} // namespace infini
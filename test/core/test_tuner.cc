@@ -0,0 +1,173 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/plan.h"
+#include "core/runtime.h"
+#include "core/tuner.h"
+#include "operators/element_wise.h"
+
+#include "test.h"
+#include <cstdio>
+#include <fstream>
+
+namespace infini {
+
+TEST(KernelRegistry, MultipleCandidates) {
+    auto &registry = KernelRegistry::sealed();
+    KernelAttrs key{Device::CPU, OpType::Add, DataType::Float32};
+    auto &candidates = registry.getKernels(key);
+    ASSERT_GE(candidates.size(), 2u);
+    EXPECT_EQ(std::get<1>(candidates.front()), "addNaive_CPU");
+    // Registration is over once lookups start
+    EXPECT_THROW(KernelRegistry::getInstance().registerKernel(
+                     key, nullptr, "addOther_CPU"),
+                 Exception);
+}
+
+TEST(KernelRegistry, DTypeKeys) {
+    auto &registry = KernelRegistry::sealed();
+    auto f32 = registry.getKernel(
+        KernelAttrs{Device::CPU, OpType::Relu, DataType::Float32});
+    auto u32 = registry.getKernel(
+        KernelAttrs{Device::CPU, OpType::Relu, DataType::UInt32});
+    EXPECT_NE(f32, u32);
+
+    // A missing (op, dtype) combination fails while compiling the plan,
+    // before any operator runs
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3}, DataType::Float32);
+    auto b = g->addTensor({2, 3}, DataType::Float32);
+    auto c = g->addTensor({2, 3}, DataType::Int32);
+    g->addOp<AddObj>(a, b, nullptr);
+    g->addOp<AddObj>(c, c, nullptr);
+    g->dataMalloc();
+    EXPECT_THROW(runtime->compile(g), Exception);
+}
+
+TEST(KernelRegistry, DenseLookup) {
+    auto &registry = KernelRegistry::sealed();
+    KernelAttrs key{Device::CPU, OpType::Add, DataType::Float32};
+    auto records = registry.findKernels(Device::CPU, OpType::Add,
+                                        DataType::Float32);
+    ASSERT_NE(records, nullptr);
+    EXPECT_EQ(records, &registry.getKernels(key));
+    EXPECT_EQ(registry.findKernel(Device::CPU, OpType::Add, DataType::Float32),
+              registry.getKernel(key));
+
+    // Missing and out-of-range keys come back empty instead of throwing
+    static_assert(noexcept(registry.findKernels(Device::CPU, OpType::Add,
+                                                DataType::Float32)));
+    EXPECT_EQ(registry.findKernels(Device::CPU, OpType::Add,
+                                   DataType::String),
+              nullptr);
+    EXPECT_EQ(registry.findKernel(Device::CPU, 1000, DataType::Float32),
+              nullptr);
+    EXPECT_EQ(registry.findKernel(Device(7), OpType::Add, DataType::Float32),
+              nullptr);
+}
+
+TEST(KernelRegistry, CheckKernels) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3}, DataType::Float32);
+    auto c = g->addTensor({2, 3}, DataType::Int64);
+    g->addOp<AddObj>(a, a, nullptr);
+    runtime->checkKernels(g);
+
+    g->addOp<AddObj>(c, c, nullptr);
+    g->addOp<SubObj>(c, c, nullptr);
+    try {
+        runtime->checkKernels(g);
+        FAIL() << "Expected missing kernels";
+    } catch (const Exception &e) {
+        // Every offending operator is reported, not just the first.
+        // Exception::what() only returns text appended with operator<<.
+        string msg = e.std::runtime_error::what();
+        EXPECT_NE(msg.find("CPU, Add, Int64"), string::npos);
+        EXPECT_NE(msg.find("CPU, Sub, Int64"), string::npos);
+    }
+}
+
+TEST(KernelTuner, SelectAndPersist) {
+    string cacheFile = testing::TempDir() + "infini_tuning_cache.txt";
+    std::remove(cacheFile.c_str());
+    auto &tuner = KernelTuner::getInstance();
+    tuner.clear();
+    tuner.setCacheFile(cacheFile);
+
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3, 4}, DataType::Float32);
+    auto b = g->addTensor({3, 1}, DataType::Float32);
+    auto op = g->addOp<AddObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+
+    auto plan = runtime->compile(g);
+    ASSERT_EQ(plan->getSteps().size(), 1u);
+    auto key = KernelTuner::getKey(op, runtime.get());
+    auto winner = tuner.lookup(key);
+    ASSERT_TRUE(winner.has_value());
+    EXPECT_EQ(plan->getSteps()[0].kernelName, *winner);
+
+    runtime->execute(plan);
+    vector<float> ans(24);
+    for (int i = 0; i < 24; ++i)
+        ans[i] = i + (i / 4) % 3;
+    EXPECT_TRUE(op->getOutput()->equalData(ans));
+
+    // A fresh process only sees the persisted entry
+    tuner.clear();
+    EXPECT_FALSE(tuner.lookup(key).has_value());
+    tuner.setCacheFile(cacheFile);
+    EXPECT_EQ(tuner.lookup(key), winner);
+
+    // Another ISA level or thread count is tuned separately, and re-tuning
+    // replaces the line of its key
+    auto scalar = make_ref<NativeCpuRuntimeObj>(CpuPartition::shared(
+        {getAvailableCpus().front()}));
+    scalar->setIsa(CpuIsa::Scalar);
+    auto scalarKey = KernelTuner::getKey(op, scalar.get());
+    EXPECT_NE(scalarKey, key);
+    EXPECT_FALSE(tuner.lookup(scalarKey).has_value());
+    scalar->compile(g);
+    EXPECT_TRUE(tuner.lookup(scalarKey).has_value());
+    tuner.clear();
+    runtime->compile(g);
+    std::ifstream ifs(cacheFile);
+    int lines = 0;
+    for (string line; std::getline(ifs, line);)
+        ++lines;
+    EXPECT_EQ(lines, 2);
+
+    tuner.setCacheFile("");
+    tuner.clear();
+    std::remove(cacheFile.c_str());
+}
+
+TEST(KernelTuner, CandidatesAgree) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 1, 3, 2}, DataType::UInt32);
+    auto b = g->addTensor({4, 1, 2}, DataType::UInt32);
+    auto op = g->addOp<MulObj>(a, b, nullptr);
+    auto ref = g->addTensor(op->getOutput()->getDims(), DataType::UInt32);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+
+    auto &candidates = KernelRegistry::sealed().getKernels(
+        KernelAttrs{Device::CPU, OpType::Mul, DataType::UInt32});
+    std::get<0>(candidates.front())->compute(op, runtime.get());
+    std::memcpy(ref->getRawDataPtr<void *>(),
+                op->getOutput()->getRawDataPtr<void *>(), ref->getBytes());
+    for (auto &record : candidates) {
+        std::memset(op->getOutput()->getRawDataPtr<void *>(), 0,
+                    ref->getBytes());
+        std::get<0>(record)->compute(op, runtime.get());
+        EXPECT_TRUE(op->getOutput()->equalData(ref)) << std::get<1>(record);
+    }
+}
+
+} // namespace infini
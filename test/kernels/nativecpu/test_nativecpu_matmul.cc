@@ -0,0 +1,268 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+
+#include "test.h"
+#include <cmath>
+#include <cstring>
+
+namespace infini {
+
+// Small integers keep every product exact in float
+static void fillPattern(const Tensor &t, int seed) {
+    auto ptr = t->getRawDataPtr<float *>();
+    for (size_t i = 0; i < t->size(); ++i)
+        ptr[i] = float(int((i * 7 + seed * 13) % 11) - 5);
+}
+
+static vector<float> reference(const Tensor &A, const Tensor &B, bool transA,
+                               bool transB, size_t batch, size_t m, size_t n,
+                               size_t k) {
+    auto a = A->getRawDataPtr<float *>(), b = B->getRawDataPtr<float *>();
+    vector<float> c(batch * m * n);
+    for (size_t s = 0; s < batch; ++s)
+        for (size_t i = 0; i < m; ++i)
+            for (size_t j = 0; j < n; ++j) {
+                double acc = 0;
+                for (size_t p = 0; p < k; ++p)
+                    acc += a[s * m * k + (transA ? p * m + i : i * k + p)] *
+                           b[s * k * n + (transB ? j * k + p : p * n + j)];
+                c[(s * m + i) * n + j] = acc;
+            }
+    return c;
+}
+
+static void testMatmul(Ref<NativeCpuRuntimeObj> runtime, size_t batch,
+                       size_t m, size_t n, size_t k, bool transA,
+                       bool transB) {
+    Graph g = make_ref<GraphObj>(runtime);
+    Shape shapeA{(int)batch, int(transA ? k : m), int(transA ? m : k)};
+    Shape shapeB{(int)batch, int(transB ? n : k), int(transB ? k : n)};
+    auto A = g->addTensor(shapeA, DataType::Float32);
+    auto B = g->addTensor(shapeB, DataType::Float32);
+    auto C = g->addOp<MatmulObj>(A, B, nullptr, transA, transB)->getOutput();
+    g->dataMalloc();
+    fillPattern(A, 1);
+    fillPattern(B, 2);
+    runtime->run(g);
+    EXPECT_TRUE(C->equalData(
+        reference(A, B, transA, transB, batch, m, n, k)))
+        << "batch=" << batch << " m=" << m << " n=" << n << " k=" << k
+        << " transA=" << transA << " transB=" << transB
+        << " isa=" << isaToString(runtime->getIsa());
+}
+
+TEST(Matmul, NativeCpuGemm) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    auto host = runtime->getIsa();
+    // Every micro-kernel the host supports, on full and partial tiles and
+    // on more than one block along each dimension
+    for (auto isa : {CpuIsa::Scalar, CpuIsa::SSE4, CpuIsa::AVX2,
+                     CpuIsa::AVX512}) {
+        if (isa > host)
+            continue;
+        runtime->setIsa(isa);
+        for (bool transA : {false, true})
+            for (bool transB : {false, true}) {
+                testMatmul(runtime, 1, 1, 1, 1, transA, transB);
+                testMatmul(runtime, 2, 7, 5, 3, transA, transB);
+                testMatmul(runtime, 1, 48, 64, 32, transA, transB);
+                testMatmul(runtime, 1, 101, 67, 300, transA, transB);
+                // GEMV: one row or one column of output
+                testMatmul(runtime, 1, 1, 1100, 37, transA, transB);
+                testMatmul(runtime, 3, 1, 6, 70, transA, transB);
+                testMatmul(runtime, 2, 45, 1, 19, transA, transB);
+                // Specialized small shapes, with row counts off the unroll
+                testMatmul(runtime, 2, 64, 64, 64, transA, transB);
+                testMatmul(runtime, 1, 7, 8, 4, transA, transB);
+                testMatmul(runtime, 3, 5, 4, 32, transA, transB);
+                testMatmul(runtime, 1, 33, 16, 16, transA, transB);
+                testMatmul(runtime, 1, 9, 12, 48, transA, transB);
+                testMatmul(runtime, 2, 5, 24, 12, transA, transB);
+                testMatmul(runtime, 1, 3, 48, 24, transA, transB);
+            }
+        testMatmul(runtime, 1, 130, 2100, 20, false, false);
+    }
+}
+
+// Leading dims broadcast: `batchA` / `batchB` hold the batch dims of A / B
+static void testBroadcast(Ref<NativeCpuRuntimeObj> runtime, Shape batchA,
+                          Shape batchB, int m, int n, int k, bool transA,
+                          bool transB) {
+    Graph g = make_ref<GraphObj>(runtime);
+    Shape shapeA = batchA, shapeB = batchB;
+    shapeA.insert(shapeA.end(), {transA ? k : m, transA ? m : k});
+    shapeB.insert(shapeB.end(), {transB ? n : k, transB ? k : n});
+    auto A = g->addTensor(shapeA, DataType::Float32);
+    auto B = g->addTensor(shapeB, DataType::Float32);
+    auto C = g->addOp<MatmulObj>(A, B, nullptr, transA, transB)->getOutput();
+    g->dataMalloc();
+    fillPattern(A, 3);
+    fillPattern(B, 4);
+    runtime->run(g);
+
+    // Batch b of C reads the batch of A / B with every broadcast index at 0
+    auto outDims = C->getDims();
+    Shape batchC(outDims.begin(), outDims.end() - 2);
+    auto locate = [&](size_t b, const Shape &dims) {
+        size_t offset = 0, stride = 1, outStride = 1;
+        for (int i = batchC.size() - 1, j = dims.size() - 1; j >= 0;
+             --i, --j) {
+            size_t idx = b / outStride % batchC[i];
+            offset += (dims[j] == 1 ? 0 : idx) * stride;
+            stride *= dims[j];
+            outStride *= batchC[i];
+        }
+        return offset;
+    };
+    size_t batch = C->size() / (m * n);
+    auto a = A->getRawDataPtr<float *>(), b = B->getRawDataPtr<float *>();
+    vector<float> ref(C->size());
+    for (size_t s = 0; s < batch; ++s) {
+        auto pa = a + locate(s, batchA) * m * k;
+        auto pb = b + locate(s, batchB) * k * n;
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                double acc = 0;
+                for (int p = 0; p < k; ++p)
+                    acc += pa[transA ? p * m + i : i * k + p] *
+                           pb[transB ? j * k + p : p * n + j];
+                ref[(s * m + i) * n + j] = acc;
+            }
+    }
+    EXPECT_TRUE(C->equalData(ref))
+        << "A=" << vecToString(shapeA) << " B=" << vecToString(shapeB);
+}
+
+TEST(Matmul, NativeCpuBroadcastBatch) {
+    // More threads than the host may have, so row tiles get exercised too
+    auto runtime =
+        make_ref<NativeCpuRuntimeObj>(CpuPartition::shared({0}, 4));
+    for (bool transA : {false, true})
+        for (bool transB : {false, true}) {
+            testBroadcast(runtime, {2, 1}, {1, 3}, 5, 7, 9, transA, transB);
+            testBroadcast(runtime, {}, {4}, 70, 33, 17, transA, transB);
+            testBroadcast(runtime, {3}, {}, 70, 33, 17, transA, transB);
+            testBroadcast(runtime, {2, 3}, {3}, 40, 8, 12, transA, transB);
+            testBroadcast(runtime, {1}, {1}, 200, 19, 24, transA, transB);
+            testBroadcast(runtime, {16}, {16}, 3, 4, 5, transA, transB);
+            testBroadcast(runtime, {}, {}, 1, 1000, 64, transA, transB);
+            testBroadcast(runtime, {2, 1}, {3}, 1, 300, 20, transA, transB);
+            testBroadcast(runtime, {5}, {}, 1, 20, 30, transA, transB);
+            testBroadcast(runtime, {}, {}, 999, 1, 33, transA, transB);
+            testBroadcast(runtime, {4}, {1}, 30, 1, 33, transA, transB);
+        }
+}
+
+// fp16 bits of a small integer, which fp16 represents exactly
+static uint16_t toHalf(float v) {
+    uint16_t sign = v < 0 ? 0x8000 : 0;
+    float mag = std::abs(v);
+    if (mag == 0)
+        return sign;
+    int e = std::ilogb(mag);
+    auto mant = uint16_t((std::ldexp(mag, -e) - 1) * 1024);
+    return sign | uint16_t((e + 15) << 10) | mant;
+}
+
+// bf16 bits: the upper half of the fp32, exact for small integers
+static uint16_t toBFloat(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits >> 16;
+}
+
+// C = A * B with B stored as Float16 or BFloat16, against the fp32 product
+static void testHalfMatmul(Ref<NativeCpuRuntimeObj> runtime, DataType bType,
+                           size_t batch, size_t m, size_t n, size_t k,
+                           bool transA, bool transB) {
+    Graph g = make_ref<GraphObj>(runtime);
+    Shape shapeA{(int)batch, int(transA ? k : m), int(transA ? m : k)};
+    Shape shapeB{(int)batch, int(transB ? n : k), int(transB ? k : n)};
+    auto A = g->addTensor(shapeA, DataType::Float32);
+    auto B = g->addTensor(shapeB, bType);
+    auto BF = g->addTensor(shapeB, DataType::Float32);
+    auto C = g->addOp<MatmulObj>(A, B, nullptr, transA, transB)->getOutput();
+    g->dataMalloc();
+    fillPattern(A, 5);
+    fillPattern(BF, 6);
+    auto bf = BF->getRawDataPtr<float *>();
+    auto b = B->getRawDataPtr<uint16_t *>();
+    for (size_t i = 0; i < B->size(); ++i)
+        b[i] = bType == DataType::Float16 ? toHalf(bf[i]) : toBFloat(bf[i]);
+    runtime->run(g);
+    EXPECT_EQ(C->getDType(), DataType::Float32);
+    EXPECT_TRUE(C->equalData(
+        reference(A, BF, transA, transB, batch, m, n, k)))
+        << bType.toString() << " batch=" << batch << " m=" << m
+        << " n=" << n << " k=" << k << " transA=" << transA
+        << " transB=" << transB << " isa=" << isaToString(runtime->getIsa());
+}
+
+TEST(Matmul, NativeCpuHalfWeights) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    auto host = runtime->getIsa();
+    for (auto isa : {CpuIsa::Scalar, CpuIsa::SSE4, CpuIsa::AVX2,
+                     CpuIsa::AVX512}) {
+        if (isa > host)
+            continue;
+        runtime->setIsa(isa);
+        for (auto bType : {DataType::Float16, DataType::BFloat16})
+            for (bool transA : {false, true})
+                for (bool transB : {false, true}) {
+                    testHalfMatmul(runtime, bType, 2, 7, 5, 3, transA,
+                                   transB);
+                    testHalfMatmul(runtime, bType, 1, 101, 67, 300, transA,
+                                   transB);
+                    // GEMV, over both layouts of W and past one L1 block
+                    testHalfMatmul(runtime, bType, 1, 1, 1100, 37, transA,
+                                   transB);
+                    testHalfMatmul(runtime, bType, 3, 1, 6, 1030, transA,
+                                   transB);
+                    testHalfMatmul(runtime, bType, 2, 45, 1, 19, transA,
+                                   transB);
+                    // Specialized small shape
+                    testHalfMatmul(runtime, bType, 1, 33, 16, 16, transA,
+                                   transB);
+                }
+    }
+}
+
+TEST(Matmul, NativeCpuHalfSpecialValues) {
+    // Subnormals, the largest finite value and infinities widen exactly
+    vector<uint16_t> bits{0x0001, 0x83ff, 0x0400, 0x7bff,
+                          0xfc00, 0x7c00, 0x3c00, 0xc000};
+    vector<float> expected{std::ldexp(1.f, -24),
+                           -std::ldexp(1023.f, -24),
+                           std::ldexp(1.f, -14),
+                           65504.f,
+                           -INFINITY,
+                           INFINITY,
+                           1.f,
+                           -2.f};
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    auto host = runtime->getIsa();
+    for (auto isa : {CpuIsa::Scalar, CpuIsa::SSE4, CpuIsa::AVX2,
+                     CpuIsa::AVX512}) {
+        if (isa > host)
+            continue;
+        runtime->setIsa(isa);
+        // 1 x 1 times 1 x 24: the GEMV path, wide enough for vector widening
+        Graph g = make_ref<GraphObj>(runtime);
+        auto A = g->addTensor({1, 1}, DataType::Float32);
+        auto B = g->addTensor({1, 24}, DataType::Float16);
+        auto C = g->addOp<MatmulObj>(A, B, nullptr)->getOutput();
+        g->dataMalloc();
+        A->getRawDataPtr<float *>()[0] = 1.f;
+        auto b = B->getRawDataPtr<uint16_t *>();
+        for (size_t i = 0; i < 24; ++i)
+            b[i] = bits[i % bits.size()];
+        runtime->run(g);
+        auto c = C->getRawDataPtr<float *>();
+        for (size_t i = 0; i < 24; ++i)
+            EXPECT_EQ(c[i], expected[i % expected.size()])
+                << "i=" << i << " isa=" << isaToString(isa);
+    }
+}
+
+} // namespace infini
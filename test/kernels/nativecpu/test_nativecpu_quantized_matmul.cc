@@ -0,0 +1,136 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/quantized_matmul.h"
+
+#include "test.h"
+
+namespace infini {
+
+static void fillInt8(const Tensor &t, int seed) {
+    auto ptr = t->getRawDataPtr<int8_t *>();
+    for (size_t i = 0; i < t->size(); ++i)
+        ptr[i] = int8_t(int((i * 37 + seed * 101) % 256) - 128);
+}
+
+constexpr float ScaleA = 0.05f, ScaleC = 8.f;
+constexpr int ZeroA = -3, ZeroC = 5;
+
+static Operator buildQuantizedMatmul(Graph g, Shape shapeA, int n,
+                                     DataType outputType) {
+    int k = shapeA.back();
+    auto A = g->addTensor(shapeA, DataType::Int8);
+    auto B = g->addTensor({k, n}, DataType::Int8);
+    auto scales = g->addTensor({n}, DataType::Float32);
+    auto zeros = g->addTensor({n}, DataType::Int8);
+    auto op = g->addOp<QuantizedMatmulObj>(A, B, scales, zeros, nullptr,
+                                           ScaleA, ZeroA, outputType, ScaleC,
+                                           ZeroC);
+    g->dataMalloc();
+    fillInt8(A, 1);
+    fillInt8(B, 2);
+    fillInt8(zeros, 3);
+    auto s = scales->getRawDataPtr<float *>();
+    for (int j = 0; j < n; ++j)
+        s[j] = 0.01f * (j % 7 + 1);
+    return op;
+}
+
+// Checks the output of `op` against a direct evaluation of the definition
+static void checkQuantizedMatmul(const Operator &op, const string &what) {
+    auto A = op->getInputs(0), B = op->getInputs(1), C = op->getOutput();
+    size_t k = A->getDims().back(), n = B->getDims()[1];
+    auto a = A->getRawDataPtr<int8_t *>(), b = B->getRawDataPtr<int8_t *>();
+    auto s = op->getInputs(2)->getRawDataPtr<float *>();
+    auto z = op->getInputs(3)->getRawDataPtr<int8_t *>();
+    size_t rows = A->size() / k;
+    vector<float> refFloat(rows * n);
+    vector<int8_t> refInt8(rows * n);
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < n; ++j) {
+            int64_t dot = 0;
+            for (size_t p = 0; p < k; ++p)
+                dot += (a[i * k + p] - ZeroA) * (b[p * n + j] - z[j]);
+            float v = ScaleA * s[j] * float(dot);
+            refFloat[i * n + j] = v;
+            refInt8[i * n + j] = (int8_t)std::clamp<long>(
+                std::lrint(v * (1.f / ScaleC)) + ZeroC, -128, 127);
+        }
+    if (C->getDType() == DataType::Float32)
+        EXPECT_TRUE(C->equalData(refFloat)) << what;
+    else
+        EXPECT_TRUE(C->equalData(refInt8)) << what;
+}
+
+static void testQuantizedMatmul(Ref<NativeCpuRuntimeObj> runtime,
+                                Shape shapeA, int n, DataType outputType) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto op = buildQuantizedMatmul(g, shapeA, n, outputType);
+    runtime->run(g);
+    checkQuantizedMatmul(op, "A=" + vecToString(shapeA) +
+                                 " n=" + std::to_string(n) + " out=" +
+                                 outputType.toString() +
+                                 " isa=" + isaToString(runtime->getIsa()));
+}
+
+TEST(QuantizedMatmul, NativeCpu) {
+    auto runtime =
+        make_ref<NativeCpuRuntimeObj>(CpuPartition::shared({0}, 3));
+    auto host = runtime->getIsa();
+    // Scalar, pmaddwd (AVX2) and, on hosts that have it, VNNI
+    for (auto isa : {CpuIsa::Scalar, CpuIsa::AVX2, CpuIsa::AVX512}) {
+        if (isa > host)
+            continue;
+        runtime->setIsa(isa);
+        for (auto type : {DataType::Float32, DataType::Int8}) {
+            testQuantizedMatmul(runtime, {1, 1}, 1, type);
+            testQuantizedMatmul(runtime, {3, 7}, 5, type);
+            testQuantizedMatmul(runtime, {2, 9, 64}, 48, type);
+            testQuantizedMatmul(runtime, {100, 131}, 37, type);
+            // Long K, accumulated over many steps of the micro-kernel
+            testQuantizedMatmul(runtime, {17, 1000}, 16, type);
+        }
+    }
+}
+
+TEST(QuantizedMatmul, LargestK) {
+    // Extreme values: the dot products come close to 255 * 255 * K, past
+    // int32, though the accumulators of the kernel do not overflow
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    auto host = runtime->getIsa();
+    for (auto isa : {CpuIsa::Scalar, CpuIsa::AVX2, CpuIsa::AVX512}) {
+        if (isa > host)
+            continue;
+        runtime->setIsa(isa);
+        Graph g = make_ref<GraphObj>(runtime);
+        auto op = buildQuantizedMatmul(g, {2, 1 << 16}, 3, DataType::Float32);
+        auto fill = [](const Tensor &t, int8_t v) {
+            auto ptr = t->getRawDataPtr<int8_t *>();
+            std::fill(ptr, ptr + t->size(), v);
+        };
+        fill(op->getInputs(0), 127);
+        fill(op->getInputs(1), -128);
+        fill(op->getInputs(3), 127);
+        runtime->run(g);
+        checkQuantizedMatmul(op, string("isa=") + isaToString(isa));
+    }
+}
+
+TEST(QuantizedMatmul, RepacksChangedWeights) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto op = buildQuantizedMatmul(g, {20, 40}, 24, DataType::Float32);
+    runtime->run(g);
+    checkQuantizedMatmul(op, "first run");
+    // Weights written in place are repacked, whether or not the version
+    // moves
+    auto B = op->getInputs(1);
+    fillInt8(B, 9);
+    B->bumpVersion();
+    runtime->run(g);
+    checkQuantizedMatmul(op, "after update");
+    fillInt8(B, 5);
+    runtime->run(g);
+    checkQuantizedMatmul(op, "after unversioned update");
+}
+
+} // namespace infini
@@ -0,0 +1,123 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/sparse_matmul.h"
+#include "utils/sparse_weight.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Small integers keep every product exact in float. About `density` of the
+// blocks of `format` hold values, some of them zero inside the block.
+static vector<float> sparsePattern(int k, int n, SparseFormat format,
+                                   int density) {
+    int bk = sparseBlockK(format), bn = sparseBlockN(format);
+    vector<float> B(size_t(k) * n, 0.f);
+    for (int p0 = 0; p0 < k; p0 += bk)
+        for (int j0 = 0; j0 < n; j0 += bn) {
+            if ((p0 * 31 + j0 * 17) % 100 >= density)
+                continue;
+            for (int p = p0; p < p0 + bk; ++p)
+                for (int j = j0; j < j0 + bn; ++j)
+                    B[size_t(p) * n + j] = float((p * 7 + j * 3) % 9 - 4);
+        }
+    return B;
+}
+
+static void testSparseMatmul(Ref<NativeCpuRuntimeObj> runtime, Shape shapeA,
+                             int n, SparseFormat format, int density) {
+    int k = shapeA.back();
+    auto dense = sparsePattern(k, n, format, density);
+    auto w = toSparse(dense.data(), k, n, format);
+
+    Graph g = make_ref<GraphObj>(runtime);
+    auto A = g->addTensor(shapeA, DataType::Float32);
+    auto weight = addSparseWeight(g, w);
+    auto C = g->addOp<SparseMatmulObj>(A, weight[0], weight[1], weight[2],
+                                       nullptr, format)
+                 ->getOutput();
+    g->dataMalloc();
+    copySparseWeight(weight, w);
+    auto a = A->getRawDataPtr<float *>();
+    for (size_t i = 0; i < A->size(); ++i)
+        a[i] = float(int((i * 5 + 3) % 7) - 3);
+    runtime->run(g);
+
+    size_t rows = A->size() / k;
+    vector<float> ref(rows * n);
+    for (size_t i = 0; i < rows; ++i)
+        for (int j = 0; j < n; ++j) {
+            double acc = 0;
+            for (int p = 0; p < k; ++p)
+                acc += a[i * k + p] * dense[size_t(p) * n + j];
+            ref[i * n + j] = acc;
+        }
+    EXPECT_TRUE(C->equalData(ref))
+        << sparseFormatToString(format) << " A=" << vecToString(shapeA)
+        << " n=" << n << " density=" << density
+        << " isa=" << isaToString(runtime->getIsa());
+}
+
+TEST(SparseMatmul, NativeCpu) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    auto host = runtime->getIsa();
+    for (auto isa : {CpuIsa::Scalar, CpuIsa::SSE4, CpuIsa::AVX2,
+                     CpuIsa::AVX512}) {
+        if (isa > host)
+            continue;
+        runtime->setIsa(isa);
+        for (auto format : {SparseFormat::CSR, SparseFormat::Block4x4,
+                            SparseFormat::Block8x1})
+            for (int density : {0, 20, 100}) {
+                // One row, rows off the unroll, and batch dims
+                testSparseMatmul(runtime, {1, 64}, 48, format, density);
+                testSparseMatmul(runtime, {3, 8}, 16, format, density);
+                testSparseMatmul(runtime, {19, 36}, 40, format, density);
+                testSparseMatmul(runtime, {2, 3, 12}, 8, format, density);
+            }
+    }
+}
+
+TEST(SparseMatmul, NativeCpuThreads) {
+    // More threads than the host may have, so row tiles and output ranges
+    // both get split
+    auto runtime =
+        make_ref<NativeCpuRuntimeObj>(CpuPartition::shared({0}, 4));
+    for (auto format : {SparseFormat::CSR, SparseFormat::Block4x4,
+                        SparseFormat::Block8x1}) {
+        testSparseMatmul(runtime, {1, 256}, 512, format, 10);
+        testSparseMatmul(runtime, {200, 64}, 96, format, 30);
+    }
+}
+
+// Runs a Block8x1 SparseMatMul with K = 8 and the given indices
+static void runBlock8x1(const vector<int32_t> &colIndices,
+                        const vector<int32_t> &rowPtr) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    Graph g = make_ref<GraphObj>(runtime);
+    int blocks = colIndices.size(), groups = rowPtr.size() - 1;
+    auto A = g->addTensor({2, 8}, DataType::Float32);
+    auto values = g->addTensor({blocks, 1, 8}, DataType::Float32);
+    auto cols = g->addTensor({blocks}, DataType::Int32);
+    auto ptr = g->addTensor({groups + 1}, DataType::Int32);
+    g->addOp<SparseMatmulObj>(A, values, cols, ptr, nullptr,
+                              SparseFormat::Block8x1);
+    g->dataMalloc();
+    A->setData(OneGenerator());
+    values->setData(OneGenerator());
+    std::copy(colIndices.begin(), colIndices.end(),
+              cols->getRawDataPtr<int32_t *>());
+    std::copy(rowPtr.begin(), rowPtr.end(), ptr->getRawDataPtr<int32_t *>());
+    runtime->run(g);
+}
+
+TEST(SparseMatmul, NativeCpuRejectsBadIndices) {
+    EXPECT_NO_THROW(runBlock8x1({0, 7}, {0, 1, 1, 2}));
+    // Input 8 of a K = 8 weight
+    EXPECT_THROW(runBlock8x1({8}, {0, 1}), Exception);
+    // Groups out of order, or reaching past the blocks
+    EXPECT_THROW(runBlock8x1({0, 7}, {0, 2, 0, 2}), Exception);
+    EXPECT_THROW(runBlock8x1({0, 7}, {0, 3, 1, 2}), Exception);
+}
+
+} // namespace infini
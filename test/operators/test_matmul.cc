@@ -51,6 +51,10 @@ namespace infini
             auto matmul = g->addOp<MatmulObj>(A, B, nullptr, true, true);
             auto C = matmul->getOutputs()[0];
             EXPECT_EQ(C->getDims(), (Shape{2, 3, 4, 2}));
+            EXPECT_EQ(matmul->getM(), 4);
+            EXPECT_EQ(matmul->getN(), 2);
+            EXPECT_EQ(matmul->getK(), 5);
+            EXPECT_EQ(matmul->getFlops(), 2u * 2 * 3 * 4 * 2 * 5);
         }
     }
 
@@ -0,0 +1,48 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/quantized_matmul.h"
+
+#include "test.h"
+
+namespace infini
+{
+
+    TEST(QuantizedMatmul, ShapeInference)
+    {
+        auto runtime = NativeCpuRuntimeObj::getInstance();
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{2, 3, 5}, DataType::Int8);
+            auto B = g->addTensor(Shape{5, 4}, DataType::Int8);
+            auto scales = g->addTensor(Shape{4}, DataType::Float32);
+            auto zeros = g->addTensor(Shape{4}, DataType::Int8);
+            auto op = g->addOp<QuantizedMatmulObj>(A, B, scales, zeros,
+                                                   nullptr, 0.1f, 0);
+            EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 4}));
+            EXPECT_EQ(op->getOutDType(), DataType::Float32);
+        }
+        {
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{3, 5}, DataType::Int8);
+            auto B = g->addTensor(Shape{5, 4}, DataType::Int8);
+            auto scales = g->addTensor(Shape{4}, DataType::Float32);
+            auto zeros = g->addTensor(Shape{4}, DataType::Int8);
+            auto op = g->addOp<QuantizedMatmulObj>(
+                A, B, scales, zeros, nullptr, 0.1f, 0, DataType::Int8, 2.f, 1);
+            EXPECT_EQ(op->getOutput()->getDims(), (Shape{3, 4}));
+            EXPECT_EQ(op->getOutDType(), DataType::Int8);
+        }
+        {
+            // One scale per output channel
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{3, 5}, DataType::Int8);
+            auto B = g->addTensor(Shape{5, 4}, DataType::Int8);
+            auto scales = g->addTensor(Shape{5}, DataType::Float32);
+            auto zeros = g->addTensor(Shape{4}, DataType::Int8);
+            EXPECT_THROW(g->addOp<QuantizedMatmulObj>(A, B, scales, zeros,
+                                                      nullptr, 0.1f, 0),
+                         Exception);
+        }
+    }
+
+} // namespace infini
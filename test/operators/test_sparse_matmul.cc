@@ -0,0 +1,115 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/sparse_matmul.h"
+#include "utils/sparse_weight.h"
+
+#include "test.h"
+
+namespace infini
+{
+
+    TEST(SparseMatmul, ShapeInference)
+    {
+        auto runtime = NativeCpuRuntimeObj::getInstance();
+        {
+            // 8 outputs in 3 groups of 8x1 blocks, 5 blocks stored
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{2, 3, 6}, DataType::Float32);
+            auto values = g->addTensor(Shape{5, 1, 8}, DataType::Float32);
+            auto cols = g->addTensor(Shape{5}, DataType::Int32);
+            auto rowPtr = g->addTensor(Shape{4}, DataType::Int32);
+            auto op = g->addOp<SparseMatmulObj>(A, values, cols, rowPtr,
+                                                nullptr,
+                                                SparseFormat::Block8x1);
+            EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 24}));
+            EXPECT_EQ(op->getOutDType(), DataType::Float32);
+            EXPECT_EQ(op->getK(), 6);
+        }
+        {
+            // K must be a multiple of the block's inputs
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{3, 6}, DataType::Float32);
+            auto values = g->addTensor(Shape{2, 4, 4}, DataType::Float32);
+            auto cols = g->addTensor(Shape{2}, DataType::Int32);
+            auto rowPtr = g->addTensor(Shape{3}, DataType::Int32);
+            EXPECT_THROW(g->addOp<SparseMatmulObj>(A, values, cols, rowPtr,
+                                                   nullptr,
+                                                   SparseFormat::Block4x4),
+                         Exception);
+        }
+        {
+            // Blocks of the wrong shape for the format
+            Graph g = make_ref<GraphObj>(runtime);
+            auto A = g->addTensor(Shape{3, 8}, DataType::Float32);
+            auto values = g->addTensor(Shape{2, 1, 8}, DataType::Float32);
+            auto cols = g->addTensor(Shape{2}, DataType::Int32);
+            auto rowPtr = g->addTensor(Shape{3}, DataType::Int32);
+            EXPECT_THROW(g->addOp<SparseMatmulObj>(A, values, cols, rowPtr,
+                                                   nullptr, SparseFormat::CSR),
+                         Exception);
+        }
+    }
+
+    TEST(SparseMatmul, ToSparse)
+    {
+        // B[4, 8] with nonzeros at (0, 1), (1, 1), (2, 6) and (3, 5)
+        vector<float> B(32, 0.f);
+        B[0 * 8 + 1] = 1;
+        B[1 * 8 + 1] = 2;
+        B[2 * 8 + 6] = 3;
+        B[3 * 8 + 5] = 4;
+
+        auto csr = toSparse(B.data(), 4, 8, SparseFormat::CSR);
+        EXPECT_EQ(csr.rowPtr, (vector<int32_t>{0, 0, 2, 2, 2, 2, 3, 4, 4}));
+        EXPECT_EQ(csr.colIndices, (vector<int32_t>{0, 1, 3, 2}));
+        EXPECT_EQ(csr.values, (vector<float>{1, 2, 4, 3}));
+
+        // One input, all 8 outputs: a block per nonzero row
+        auto rows = toSparse(B.data(), 4, 8, SparseFormat::Block8x1);
+        EXPECT_EQ(rows.rowPtr, (vector<int32_t>{0, 4}));
+        EXPECT_EQ(rows.colIndices, (vector<int32_t>{0, 1, 2, 3}));
+        EXPECT_EQ(rows.values.size(), 32u);
+
+        // Outputs 4..7 of inputs 0..3 hold the last two nonzeros
+        auto tiles = toSparse(B.data(), 4, 8, SparseFormat::Block4x4);
+        EXPECT_EQ(tiles.rowPtr, (vector<int32_t>{0, 1, 2}));
+        EXPECT_EQ(tiles.colIndices, (vector<int32_t>{0, 0}));
+        EXPECT_EQ(tiles.values[2 * 4 + 2], 0.f);
+        EXPECT_EQ(tiles.values[16 + 2 * 4 + 2], 3.f);
+        EXPECT_EQ(tiles.values[16 + 3 * 4 + 1], 4.f);
+        EXPECT_EQ(tiles.bytes(), (32 + 3 + 2) * 4u);
+
+        EXPECT_THROW(toSparse(B.data(), 4, 6, SparseFormat::Block8x1),
+                     Exception);
+    }
+
+    TEST(SparseMatmul, ChooseFormat)
+    {
+        int k = 64, n = 64;
+        vector<float> B(k * n, 0.f);
+        // Dense weights stay dense
+        std::fill(B.begin(), B.end(), 1.f);
+        EXPECT_FALSE(chooseSparseFormat(B.data(), k, n).has_value());
+
+        // 90% of 8x1 blocks empty: the block format
+        std::fill(B.begin(), B.end(), 0.f);
+        for (int p = 0; p < k; ++p)
+            for (int j = 0; j < n; j += 8)
+                if ((p * 8 + j) % 80 == 0)
+                    std::fill(B.begin() + p * n + j,
+                              B.begin() + p * n + j + 8, 1.f);
+        EXPECT_EQ(chooseSparseFormat(B.data(), k, n),
+                  SparseFormat::Block8x1);
+
+        // Scattered nonzeros, 1 in 9: CSR for a GEMV, dense for a batch
+        std::fill(B.begin(), B.end(), 0.f);
+        for (int i = 0; i < k * n; i += 9)
+            B[i] = 1.f;
+        EXPECT_EQ(chooseSparseFormat(B.data(), k, n), SparseFormat::CSR);
+        EXPECT_FALSE(chooseSparseFormat(B.data(), k, n, 64).has_value());
+
+        // Only formats that tile the weight are considered
+        EXPECT_EQ(chooseSparseFormat(B.data(), 63, 65), SparseFormat::CSR);
+    }
+
+} // namespace infini
@@ -0,0 +1,89 @@
+// Reruns a trace recorded with Trace::record() and compares the timings.
+//
+//   trace_replay TRACE [--step N] [--kernel OP=NAME]... [--threads N]
+//                [--repeat N] [--isa NAME]
+#include "core/trace.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace infini;
+
+static void usage() {
+    std::fprintf(stderr,
+                 "usage: trace_replay TRACE [--step N] [--kernel OP=NAME]... "
+                 "[--threads N] [--repeat N] [--isa NAME]\n");
+    std::exit(2);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2)
+        usage();
+    string path = argv[1];
+    ReplayOptions options;
+    int threads = 0;
+    optional<CpuIsa> isa;
+    for (int i = 2; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+            usage();
+        string value = argv[++i];
+        if (arg == "--step") {
+            options.step = std::stoul(value);
+        } else if (arg == "--kernel") {
+            auto eq = value.find('=');
+            if (eq == string::npos)
+                usage();
+            options.kernels[value.substr(0, eq)] = value.substr(eq + 1);
+        } else if (arg == "--threads") {
+            threads = std::stoi(value);
+        } else if (arg == "--repeat") {
+            options.repeat = std::stoi(value);
+        } else if (arg == "--isa") {
+            isa = isaFromString(value);
+            if (!isa)
+                usage();
+        } else {
+            usage();
+        }
+    }
+
+    try {
+        auto trace = Trace::load(path);
+        auto runtime = make_ref<NativeCpuRuntimeObj>(
+            CpuPartition::shared(getAvailableCpus(), threads));
+        runtime->setIsa(isa.value_or(std::min(trace.isa, runtime->getIsa())));
+        auto result = replayTrace(trace, runtime, options);
+
+        std::printf("%s: %zu steps, recorded with %d threads at %s; "
+                    "replayed with %d threads at %s\n",
+                    path.c_str(), trace.steps.size(), trace.numThreads,
+                    isaToString(trace.isa),
+                    runtime->getThreadPool().getNumThreads(),
+                    isaToString(runtime->getIsa()));
+        std::printf("%5s  %-10s %-22s %-22s %12s %12s\n", "step", "op",
+                    "recorded kernel", "replayed kernel", "recorded us",
+                    "replayed us");
+        double recordedTotal = 0, replayedTotal = 0;
+        for (size_t i = 0; i < result.steps.size(); ++i) {
+            auto &s = trace.steps[result.steps[i]];
+            double recorded = s.nanos / 1e3, replayed = result.nanos[i] / 1e3;
+            recordedTotal += recorded;
+            replayedTotal += replayed;
+            std::printf("%5zu  %-10s %-22s %-22s %12.1f %12.1f\n",
+                        result.steps[i], s.type.toString(),
+                        s.kernelName.c_str(), result.kernelNames[i].c_str(),
+                        recorded, replayed);
+        }
+        std::printf("%5s  %-10s %-22s %-22s %12.1f %12.1f\n", "total", "", "",
+                    "", recordedTotal, replayedTotal);
+    } catch (const Exception &e) {
+        // Exception::what() only holds text appended with operator<<
+        std::fprintf(stderr, "trace_replay: %s\n",
+                     e.std::runtime_error::what());
+        return 1;
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "trace_replay: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}